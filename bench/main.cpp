@@ -0,0 +1,493 @@
+#include <dint.h>
+#include <philox.h>
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <unordered_map>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace bigint;
+
+/**
+ * @brief cycle counter, nanoseconds on platforms without a time stamp counter
+ */
+static unsigned long long cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return static_cast<unsigned long long>(
+		chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+struct options
+{
+	size_t max_bits{size_t{1} << 21};
+	size_t max_mul_bits{size_t{1} << 18};
+	double min_time{0.002};
+	int repeats{5};
+	string format{"csv"};
+	string filter{};
+	string baseline{};
+	double threshold{10};
+	double soak{0};
+};
+
+struct result
+{
+	string op;
+	string shape;
+	size_t limbs;
+	double ns;
+	double cycles;
+
+	double cycles_per_limb() const
+	{
+		return cycles / static_cast<double>(limbs);
+	}
+};
+
+// Keeps the results of the benchmarked operations alive
+static volatile size_t sink;
+
+/**
+ * @brief time per call of f, the minimum over a number of repeats of batches that each take at least min_time
+ */
+static result measure(const string &op, const string &shape, size_t limbs, const function<void()> &f, const options &opt)
+{
+	size_t calls = 1;
+
+	// Calibrate the batch size
+	while (true)
+	{
+		auto t0 = chrono::steady_clock::now();
+		for (size_t i = 0; i < calls; i++)
+		{
+			f();
+		}
+		double t = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+		if (t >= opt.min_time)
+		{
+			break;
+		}
+
+		calls = t <= 0 ? calls * 10 : max(calls + 1, static_cast<size_t>(calls * opt.min_time / t * 1.2));
+	}
+
+	double best_ns	   = numeric_limits<double>::max();
+	double best_cycles = numeric_limits<double>::max();
+
+	for (int r = 0; r < opt.repeats; r++)
+	{
+		auto t0					= chrono::steady_clock::now();
+		unsigned long long c0 = cycles();
+
+		for (size_t i = 0; i < calls; i++)
+		{
+			f();
+		}
+
+		unsigned long long c1 = cycles();
+		double t			  = chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count();
+
+		best_ns		= min(best_ns, t / static_cast<double>(calls));
+		best_cycles = min(best_cycles, static_cast<double>(c1 - c0) / static_cast<double>(calls));
+	}
+
+	return result{op, shape, limbs, best_ns, best_cycles};
+}
+
+static vector<result> run(const options &opt)
+{
+	vector<result> results;
+
+	philox gen{2024};
+
+	auto wanted = [&](const string &op) { return opt.filter.empty() || opt.filter == op; };
+
+	for (size_t limbs = 1; limbs * bits_per_word <= opt.max_bits; limbs *= 2)
+	{
+		const size_t bits	= limbs * bits_per_word;
+		const size_t little = max(bits / 4, size_t{bits_per_word});
+
+		dint a, b, c, r;
+		a.random_exact_bits(bits, gen);
+		b.random_exact_bits(bits, gen);
+		c.random_exact_bits(little, gen);
+
+		// b < a, so the subtraction does not change sign
+		if (a < b)
+		{
+			swap(a, b);
+		}
+
+		// Equal except for the lowest word, the worst case of the comparison
+		dint e{a};
+		e ^= dint{1ULL};
+
+		auto bench = [&](const string &op, const string &shape, const function<void()> &f)
+		{
+			if (wanted(op))
+			{
+				results.push_back(measure(op, shape, limbs, f, opt));
+			}
+		};
+
+		bench("add", "balanced", [&] { r = a + b; sink = r.size(); });
+		bench("add", "unbalanced", [&] { r = a + c; sink = r.size(); });
+		bench("sub", "balanced", [&] { r = a - b; sink = r.size(); });
+		bench("sub", "unbalanced", [&] { r = a - c; sink = r.size(); });
+
+		if (bits <= opt.max_mul_bits)
+		{
+			bench("mul", "balanced", [&] { r = a * b; sink = r.size(); });
+			bench("mul", "unbalanced", [&] { r = a * c; sink = r.size(); });
+			bench("sqr", "balanced", [&] { r = a * a; sink = r.size(); });
+		}
+
+		bench("shl", "balanced", [&] { r = a << 13; sink = r.size(); });
+		bench("shr", "balanced", [&] { r = a >> 13; sink = r.size(); });
+		bench("cmp", "balanced", [&] { sink = a < e; });
+		bench("cmp", "unbalanced", [&] { sink = a < c; });
+		bench("tohex", "balanced", [&] { sink = a.toHexString().size(); });
+		bench("tou64", "balanced", [&] { sink = static_cast<unsigned long long>(a); });
+		bench("hash", "balanced", [&] { sink = a.hash(); });
+
+		// Hash map throughput, the times are per key
+		if (wanted("map") && limbs <= 4096)
+		{
+			const size_t count = 1024;
+
+			vector<dint> keys(count);
+			for (dint &k : keys)
+			{
+				k.random_exact_bits(bits, gen);
+			}
+
+			unordered_map<dint, size_t> m;
+
+			auto per_key = [&](result r)
+			{
+				r.ns /= count;
+				r.cycles /= count;
+				results.push_back(r);
+			};
+
+			per_key(measure("map", "insert", limbs,
+							[&]
+							{
+								m.clear();
+								for (const dint &k : keys)
+								{
+									m.emplace(k, 0);
+								}
+								sink = m.size();
+							},
+							opt));
+
+			per_key(measure("map", "find", limbs,
+							[&]
+							{
+								size_t found = 0;
+								for (const dint &k : keys)
+								{
+									found += m.count(k);
+								}
+								sink = found;
+							},
+							opt));
+		}
+	}
+
+	return results;
+}
+
+static void write_csv(ostream &out, const vector<result> &results)
+{
+	out << "op,shape,limbs,bits,ns,cycles,cycles_per_limb\n";
+
+	for (const result &r : results)
+	{
+		out << r.op << ',' << r.shape << ',' << r.limbs << ',' << r.limbs * bits_per_word << ',' << fixed
+			<< setprecision(2) << r.ns << ',' << r.cycles << ',' << setprecision(4) << r.cycles_per_limb() << '\n';
+	}
+}
+
+static void write_json(ostream &out, const vector<result> &results)
+{
+	out << "{\n  \"limb_bits\": " << bits_per_word << ",\n  \"results\": [\n";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const result &r = results[i];
+
+		out << "    {\"op\": \"" << r.op << "\", \"shape\": \"" << r.shape << "\", \"limbs\": " << r.limbs
+			<< ", \"bits\": " << r.limbs * bits_per_word << ", \"ns\": " << fixed << setprecision(2) << r.ns
+			<< ", \"cycles\": " << r.cycles << ", \"cycles_per_limb\": " << setprecision(4) << r.cycles_per_limb()
+			<< "}" << (i + 1 < results.size() ? "," : "") << '\n';
+	}
+
+	out << "  ]\n}\n";
+}
+
+/**
+ * @brief reads cycles per limb from a csv written by write_csv
+ */
+static map<tuple<string, string, size_t>, double> read_baseline(const string &file)
+{
+	map<tuple<string, string, size_t>, double> r;
+
+	ifstream in{file};
+
+	if (!in)
+	{
+		throw runtime_error("cannot read baseline " + file);
+	}
+
+	string line;
+	getline(in, line);
+
+	while (getline(in, line))
+	{
+		vector<string> fields;
+		istringstream s{line};
+
+		for (string f; getline(s, f, ',');)
+		{
+			fields.push_back(f);
+		}
+
+		if (fields.size() == 7)
+		{
+			r[{fields[0], fields[1], stoul(fields[2])}] = stod(fields[6]);
+		}
+	}
+
+	return r;
+}
+
+/**
+ * @brief lists the results that are more than threshold percent slower than the baseline
+ *
+ * @return the number of regressions
+ */
+static size_t compare(const vector<result> &results, const options &opt)
+{
+	auto baseline = read_baseline(opt.baseline);
+
+	size_t regressions = 0;
+
+	for (const result &r : results)
+	{
+		auto p = baseline.find({r.op, r.shape, r.limbs});
+
+		if (p == baseline.end())
+		{
+			continue;
+		}
+
+		double change = (r.cycles_per_limb() / p->second - 1) * 100;
+
+		if (change > opt.threshold)
+		{
+			cerr << "regression: " << r.op << ' ' << r.shape << ' ' << r.limbs << " limbs: " << fixed << setprecision(4)
+				 << p->second << " -> " << r.cycles_per_limb() << " cycles per limb (+" << setprecision(1) << change
+				 << "%)\n";
+			regressions++;
+		}
+	}
+
+	return regressions;
+}
+
+/**
+ * @brief resident set size in kB, the peak on systems without /proc
+ */
+static size_t rss()
+{
+	ifstream statm{"/proc/self/statm"};
+	size_t pages, resident;
+
+	if (statm >> pages >> resident)
+	{
+		return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 1024;
+	}
+
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	return static_cast<size_t>(usage.ru_maxrss);
+}
+
+/**
+ * @brief Adds and substracts numbers of mixed sizes for opt.soak seconds and samples the resident set size.
+ * Half of the differences cancel in the top words, which is where the normalization of the substraction works.
+ *
+ * @return whether the resident set grew more than threshold percent after the first sample
+ */
+static bool soak(const options &opt)
+{
+	philox gen{2024};
+
+	std::uniform_int_distribution<size_t> distribbits(1, 4096 * bits_per_word);
+
+	const int samples = 20;
+
+	size_t operations = 0;
+	size_t first	  = 0;
+	size_t last		  = 0;
+
+	auto t0 = chrono::steady_clock::now();
+
+	cout << "seconds,operations,rss_kb\n";
+
+	for (int s = 1; s <= samples; s++)
+	{
+		while (chrono::duration<double>(chrono::steady_clock::now() - t0).count() < opt.soak * s / samples)
+		{
+			for (int i = 0; i < 1000; i++)
+			{
+				dint a, b, r;
+				a.random_bits(distribbits(gen), gen);
+
+				if (i % 2 == 0)
+				{
+					b = a;
+					b += dint{static_cast<unsigned long long>(gen())};
+				}
+				else
+				{
+					b.random_bits(distribbits(gen), gen);
+				}
+
+				r = a - b;
+				r -= a;
+				r += b;
+				sink = r.size();
+			}
+
+			operations += 3000;
+		}
+
+		last = rss();
+
+		if (s == 1)
+		{
+			first = last;
+		}
+
+		cout << fixed << setprecision(1) << chrono::duration<double>(chrono::steady_clock::now() - t0).count() << ','
+			 << operations << ',' << last << endl;
+	}
+
+	double growth = (static_cast<double>(last) / static_cast<double>(first) - 1) * 100;
+
+	if (growth > opt.threshold)
+	{
+		cerr << "rss grew from " << first << " kB to " << last << " kB (+" << setprecision(1) << growth << "%)\n";
+		return true;
+	}
+
+	return false;
+}
+
+static void usage()
+{
+	cerr << "usage: bench [--csv | --json] [--max-bits N] [--max-mul-bits N] [--min-time SECONDS] [--repeats N]\n"
+			"             [--filter OP] [--baseline FILE.csv] [--threshold PERCENT] [--soak SECONDS]\n";
+}
+
+int main(int argc, char const *argv[])
+{
+	options opt;
+
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+
+		auto value = [&]() -> string
+		{
+			if (i + 1 >= argc)
+			{
+				usage();
+				exit(2);
+			}
+			return argv[++i];
+		};
+
+		if (arg == "--csv" || arg == "--json")
+		{
+			opt.format = arg.substr(2);
+		}
+		else if (arg == "--max-bits")
+		{
+			opt.max_bits = stoul(value());
+		}
+		else if (arg == "--max-mul-bits")
+		{
+			opt.max_mul_bits = stoul(value());
+		}
+		else if (arg == "--min-time")
+		{
+			opt.min_time = stod(value());
+		}
+		else if (arg == "--repeats")
+		{
+			opt.repeats = stoi(value());
+		}
+		else if (arg == "--filter")
+		{
+			opt.filter = value();
+		}
+		else if (arg == "--baseline")
+		{
+			opt.baseline = value();
+		}
+		else if (arg == "--threshold")
+		{
+			opt.threshold = stod(value());
+		}
+		else if (arg == "--soak")
+		{
+			opt.soak = stod(value());
+		}
+		else
+		{
+			usage();
+			return 2;
+		}
+	}
+
+	if (opt.soak > 0)
+	{
+		return soak(opt) ? 1 : 0;
+	}
+
+	vector<result> results = run(opt);
+
+	if (opt.format == "json")
+	{
+		write_json(cout, results);
+	}
+	else
+	{
+		write_csv(cout, results);
+	}
+
+	if (!opt.baseline.empty() && compare(results, opt) > 0)
+	{
+		return 1;
+	}
+
+	return 0;
+}
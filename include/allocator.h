@@ -0,0 +1,194 @@
+#pragma once
+
+#include "common.h"
+#include "stats.h"
+
+#include <memory_resource>
+
+namespace bigint
+{
+using namespace std;
+
+// The memory resource new numbers take their words from on this thread, nullptr is the global heap
+extern thread_local pmr::memory_resource *current_resource;
+
+/**
+ * @brief The allocator of the words of a dint.
+ * It takes the memory resource that is current on the thread when it is created, see resource_scope.
+ * Move assignment only takes over the storage if both numbers use the same resource, so a number
+ * that was created outside of an arena never ends up with memory of that arena.
+ */
+template <class T>
+class limb_allocator
+{
+  public:
+	using value_type = T;
+
+	using propagate_on_container_copy_assignment = false_type;
+	using propagate_on_container_move_assignment = false_type;
+	using propagate_on_container_swap			 = true_type;
+	using is_always_equal						 = false_type;
+
+	limb_allocator() : resource{current_resource}
+	{
+	}
+
+	explicit limb_allocator(pmr::memory_resource *r) : resource{r}
+	{
+	}
+
+	template <class U>
+	limb_allocator(const limb_allocator<U> &a) : resource{a.resource}
+	{
+	}
+
+	T *allocate(size_t n)
+	{
+		BIGINT_STAT(counters.allocated(n * sizeof(T));)
+
+		if (resource == nullptr)
+		{
+			return allocator<T>{}.allocate(n);
+		}
+
+		return static_cast<T *>(resource->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T *p, size_t n)
+	{
+		BIGINT_STAT(counters.deallocated(n * sizeof(T));)
+
+		if (resource == nullptr)
+		{
+			allocator<T>{}.deallocate(p, n);
+		}
+		else
+		{
+			resource->deallocate(p, n * sizeof(T), alignof(T));
+		}
+	}
+
+	// Copies of a number use the resource that is current at the time of the copy
+	limb_allocator select_on_container_copy_construction() const
+	{
+		return limb_allocator{};
+	}
+
+	template <class U>
+	bool operator==(const limb_allocator<U> &a) const
+	{
+		return resource == a.resource;
+	}
+
+	pmr::memory_resource *resource;
+};
+
+/**
+ * @brief Makes a memory resource current on this thread while it lives, the previous one is restored after.
+ * The numbers created in the scope must not be used after the resource released its memory,
+ * results that have to outlive it can be copied or move assigned to numbers from outside the scope.
+ */
+class resource_scope
+{
+  public:
+	explicit resource_scope(pmr::memory_resource *r) : previous{current_resource}
+	{
+		current_resource = r;
+	}
+
+	resource_scope(const resource_scope &)			  = delete;
+	resource_scope &operator=(const resource_scope &) = delete;
+
+	~resource_scope()
+	{
+		current_resource = previous;
+	}
+
+  private:
+	pmr::memory_resource *previous;
+};
+
+/**
+ * @brief Hands out memory by moving a pointer through blocks it gets from upstream, deallocation does nothing.
+ * Everything is given back at once by release() or the destructor, which makes it the cheapest resource
+ * for the numbers of one request.
+ */
+class arena : public pmr::memory_resource
+{
+  public:
+	explicit arena(size_t initial = 1 << 16, pmr::memory_resource *upstream = pmr::new_delete_resource());
+
+	arena(const arena &)			= delete;
+	arena &operator=(const arena &) = delete;
+
+	~arena() override;
+
+	void release();
+
+	// The number of bytes handed out since the last release
+	size_t used() const;
+
+  private:
+	struct block
+	{
+		block *next;
+		size_t size;
+	};
+
+	pmr::memory_resource *upstream;
+	size_t initial;
+	size_t next_size;
+	block *blocks{nullptr};
+	char *p{nullptr};
+	char *end{nullptr};
+	size_t bytes{0};
+
+	void *do_allocate(size_t, size_t) override;
+	void do_deallocate(void *, size_t, size_t) override;
+	bool do_is_equal(const pmr::memory_resource &) const noexcept override;
+};
+
+/**
+ * @brief Recycles memory in power of two size classes, the sizes a growing vector of words asks for.
+ * Every class keeps a free list of blocks that are carved from chunks from upstream.
+ * Requests above the biggest class go to upstream directly. Not thread safe, use one pool per thread.
+ */
+class limb_pool : public pmr::memory_resource
+{
+  public:
+	// The smallest and the biggest size class, in bytes
+	static constexpr size_t min_class = 16;
+	static constexpr size_t max_class = size_t{1} << 16;
+
+	explicit limb_pool(pmr::memory_resource *upstream = pmr::new_delete_resource());
+
+	limb_pool(const limb_pool &)			= delete;
+	limb_pool &operator=(const limb_pool &) = delete;
+
+	~limb_pool() override;
+
+	// Gives the chunks back to upstream, also the memory that is still in use
+	void release();
+
+  private:
+	static constexpr size_t classes = bit_width(max_class) - bit_width(min_class) + 1;
+
+	// Chunks are at least this big, the small classes get many blocks per chunk
+	static constexpr size_t chunk_size = size_t{1} << 16;
+
+	struct node
+	{
+		node *next;
+	};
+
+	pmr::memory_resource *upstream;
+	array<node *, classes> free{};
+	vector<pair<void *, size_t>> chunks;
+
+	static size_t size_class(size_t);
+
+	void *do_allocate(size_t, size_t) override;
+	void do_deallocate(void *, size_t, size_t) override;
+	bool do_is_equal(const pmr::memory_resource &) const noexcept override;
+};
+} // namespace bigint
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "dint.h"
+#include "progress.h"
+
+#include <condition_variable>
+#include <coroutine>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace bigint
+{
+/**
+ * @brief Runs tasks somewhere else than on the calling thread.
+ */
+class executor
+{
+  public:
+	virtual ~executor() = default;
+
+	virtual void execute(function<void()>) = 0;
+};
+
+/**
+ * @brief A fixed number of threads that take tasks from a queue in order.
+ * The destructor runs the tasks that are still queued and then joins the threads.
+ */
+class thread_pool : public executor
+{
+  public:
+	explicit thread_pool(size_t threads = 0);
+	~thread_pool();
+
+	void execute(function<void()>) override;
+
+  private:
+	mutex lock;
+	condition_variable ready;
+	deque<function<void()>> tasks;
+	bool stopping{false};
+
+	vector<thread> workers;
+};
+
+// A thread_pool with a thread per hardware thread, made at the first call
+executor &default_executor();
+
+struct async_options
+{
+	// default_executor() when nullptr
+	executor *on{nullptr};
+
+	cancellation_token token;
+
+	// Gets the fraction done, called on the thread that does the work
+	function<void(double)> progress;
+};
+
+/**
+ * @brief A computation that runs on an executor once it is awaited or its future is asked for.
+ * A coroutine that awaits it is suspended until the result is there and is resumed on the thread of the executor that
+ * computed it. The exceptions of the computation, operation_cancelled among them, are thrown by co_await or the future.
+ */
+template <class T>
+class async_operation
+{
+  public:
+	async_operation(function<T()> work, uint64_t total, async_options options)
+		: state{make_shared<shared_state>(move(work), total, move(options))}
+	{
+	}
+
+	bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	void await_suspend(coroutine_handle<> awaiting)
+	{
+		// The awaiting coroutine, and this with it, can be gone before execute returns
+		shared_ptr<shared_state> s = state;
+
+		executor &on = s->options.on ? *s->options.on : default_executor();
+
+		on.execute(
+			[s, awaiting]
+			{
+				s->run();
+				awaiting.resume();
+			});
+	}
+
+	T await_resume()
+	{
+		if (state->error)
+		{
+			rethrow_exception(state->error);
+		}
+
+		return move(*state->result);
+	}
+
+	// Starts the computation for a caller that is not a coroutine
+	future<T> get_future()
+	{
+		shared_ptr<shared_state> s = state;
+		shared_ptr<promise<T>> p   = make_shared<promise<T>>();
+
+		future<T> f = p->get_future();
+
+		executor &on = s->options.on ? *s->options.on : default_executor();
+
+		on.execute(
+			[s, p]
+			{
+				s->run();
+
+				if (s->error)
+				{
+					p->set_exception(s->error);
+				}
+				else
+				{
+					p->set_value(move(*s->result));
+				}
+			});
+
+		return f;
+	}
+
+  private:
+	struct shared_state
+	{
+		function<T()> work;
+		uint64_t total;
+		async_options options;
+
+		optional<T> result;
+		exception_ptr error;
+
+		shared_state(function<T()> w, uint64_t t, async_options o) : work{move(w)}, total{t}, options{move(o)} {}
+
+		void run()
+		{
+			try
+			{
+				progress p{options.token, options.progress, total};
+
+				// Nothing is started for a token that is cancelled already
+				p.work(0);
+
+				result = work();
+
+				p.finish();
+			}
+			catch (...)
+			{
+				error = current_exception();
+			}
+		}
+	};
+
+	shared_ptr<shared_state> state;
+};
+
+async_operation<dint> async_mult(dint, dint, async_options);
+async_operation<pair<dint, dint>> async_divmod(dint, dint, async_options);
+async_operation<dint> async_powmod(dint, dint, dint, async_options);
+async_operation<string> async_to_string(dint, async_options);
+
+// Overloads instead of default arguments, GCC 12 destroys a defaulted async_options in a co_await expression twice
+async_operation<dint> async_mult(dint, dint);
+async_operation<pair<dint, dint>> async_divmod(dint, dint);
+async_operation<dint> async_powmod(dint, dint, dint);
+async_operation<string> async_to_string(dint);
+} // namespace bigint
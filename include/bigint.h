@@ -1,3 +1,5 @@
+#pragma once
+
 #include "common.h"
 
 namespace bigint
@@ -11,7 +13,8 @@ class bigint
 						const iterator &, const iterator &, const bool = false);
 
 	template <class const_iterator, class iterator>
+		requires std::input_iterator<const_iterator> && std::forward_iterator<iterator>
 	static bool subiter(const const_iterator &, const const_iterator &, const const_iterator &, const const_iterator &,
-						const iterator &, const iterator &, iterator *, const bool = false);
+						const iterator &, const iterator &, const bool = false);
 };
 } // namespace bigint
\ No newline at end of file
@@ -11,5 +11,13 @@
 #include <string>
 #include <algorithm>
 #include <random>
+#include <numeric>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <span>
+#include <compare>
+#include <functional>
 
 #define debugprint 0
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "dint.h"
+
+namespace bigint
+{
+/**
+ * @brief A binary floating point number m 2^e with a dint mantissa of a chosen number of bits.
+ * Every operation is correctly rounded to the nearest, ties to even, at the precision of the result,
+ * which for the operators is the largest precision of the operands.
+ * Operands with many more bits than the result are cut to the precision of the result plus guard bits first,
+ * with a short product for multiplication, and only when that does not decide the rounding the exact result is computed.
+ */
+class dfloat
+{
+  public:
+	static constexpr size_t default_precision = 256;
+
+	dfloat() = default;
+	dfloat(const dint &, size_t precision = default_precision);
+	explicit dfloat(double, size_t precision = default_precision);
+
+	size_t precision() const;
+	void set_precision(size_t);
+
+	// The value is mantissa() 2^exponent(), the mantissa has exactly precision() bits or is 0
+	const dint &mantissa() const;
+	long long exponent() const;
+
+	bool neg() const;
+	bool is_zero() const;
+
+	dint to_dint() const;
+	explicit operator double() const;
+
+	string toHexString() const;
+
+	dfloat operator-() const;
+
+	friend dfloat add(const dfloat &, const dfloat &, size_t);
+	friend dfloat sub(const dfloat &, const dfloat &, size_t);
+	friend dfloat mul(const dfloat &, const dfloat &, size_t);
+	friend dfloat div(const dfloat &, const dfloat &, size_t);
+	friend dfloat sqrt(const dfloat &, size_t);
+
+	friend dfloat ldexp(const dfloat &, long long);
+
+	friend dfloat operator+(const dfloat &, const dfloat &);
+	friend dfloat operator-(const dfloat &, const dfloat &);
+	friend dfloat operator*(const dfloat &, const dfloat &);
+	friend dfloat operator/(const dfloat &, const dfloat &);
+
+	friend int compare(const dfloat &, const dfloat &);
+	friend bool operator==(const dfloat &, const dfloat &);
+	friend strong_ordering operator<=>(const dfloat &, const dfloat &);
+
+  private:
+	dint m;
+	long long e{0};
+	size_t prec{default_precision};
+
+	// Bits kept beyond the precision of the result when the operands are cut
+	static constexpr size_t guard_bits = 64;
+
+	static dfloat rounded(dint, long long, size_t, bool = false);
+	static dfloat add_signed(const dfloat &, const dfloat &, bool, size_t);
+};
+} // namespace bigint
@@ -1,18 +1,27 @@
+#pragma once
+
 #include "common.h"
 #include "bigint.h"
+#include "allocator.h"
 
 namespace bigint
 {
 using namespace std;
 
 using base		= unsigned char;
-using container = vector<base>;
+using container = vector<base, limb_allocator<base>>;
 
 using iterator		 = container::iterator;
 using const_iterator = container::const_iterator;
 
 constexpr unsigned short bits_per_word = sizeof(base) * __CHAR_BIT__;
 
+// Puts the next characters of an input, at most the number asked for, in the buffer and returns how many, 0 at its end
+using digit_source = function<size_t(char *, size_t)>;
+
+// Takes the next characters of an output
+using digit_sink = function<void(const char *, size_t)>;
+
 class dint : private bigint
 {
   public:
@@ -53,6 +62,26 @@ class dint : private bigint
 	dint &operator<<=(unsigned int);
 	dint &operator>>=(unsigned int);
 
+	dint operator~() const;
+
+	dint &operator&=(const dint &);
+	dint &operator|=(const dint &);
+	dint &operator^=(const dint &);
+
+	friend dint operator&(const dint &, const dint &);
+	friend dint operator|(const dint &, const dint &);
+	friend dint operator^(const dint &, const dint &);
+
+	bool test_bit(size_t) const;
+	void set_bit(size_t);
+	void clear_bit(size_t);
+
+	size_t bit_length() const;
+	size_t popcount() const;
+	size_t countr_zero() const;
+
+	friend size_t hamming_distance(const dint &, const dint &);
+
 	friend dint operator+(const dint &, const dint &);
 	friend dint &operator+(const dint &, dint &&);
 
@@ -63,16 +92,68 @@ class dint : private bigint
 	friend bool operator<(const dint &, const dint &);
 	friend bool operator==(const dint &, const dint &);
 
+	friend int compare(const dint &, const dint &);
+	friend strong_ordering operator<=>(const dint &, const dint &);
+
 	friend dint operator*(const dint &, const dint &);
 	friend dint operator*(const dint &, base);
 
 	friend void mult(const dint &, const dint &, dint &);
+	friend dint mullow(const dint &, const dint &, size_t);
+	friend dint mulhigh(const dint &, const dint &, size_t);
+	friend dint middle_product(const dint &, const dint &, size_t);
 
 	void operator*=(const dint &);
 	void operator*=(base);
 
+	friend void divmod(const dint &, const dint &, dint &, dint &);
+	friend dint operator/(const dint &, const dint &);
+	friend dint operator%(const dint &, const dint &);
+
+	void operator/=(const dint &);
+	void operator%=(const dint &);
+
+	friend dint gcd(const dint &, const dint &);
+	friend dint lcm(const dint &, const dint &);
+	friend dint gcdext(const dint &, const dint &, dint &, dint &);
+	friend dint invmod(const dint &, const dint &);
+
+	friend unsigned long long mod_word(const dint &, unsigned long long);
+
+	friend dint divexact(const dint &, const dint &);
+	friend dint divexact_by_small(const dint &, unsigned long long);
+	friend bool divisible_p(const dint &, const dint &);
+	friend bool divisible_p(const dint &, unsigned long long);
+	friend bool congruent_p(const dint &, const dint &, const dint &);
+
+	friend dint pow(const dint &, unsigned long long);
+
+	friend dint isqrt(const dint &);
+	friend void sqrtrem(const dint &, dint &, dint &);
+	friend dint iroot(const dint &, unsigned long long);
+	friend bool is_perfect_square(const dint &);
+	friend bool is_perfect_power(const dint &);
+
+	friend dint powmod(const dint &, const dint &, const dint &);
+
+	friend bool is_probable_prime(const dint &, int);
+	friend dint next_prime(const dint &);
+	friend dint random_prime(size_t, std::mt19937 &);
+
+	friend class montgomery;
+	friend class multimodular;
+	friend class dpoly;
+	friend class flat_dint_array;
+	friend class mapped_dint;
+	friend void write_hex(const dint &, const digit_sink &);
+	friend void sort_dints(span<dint>, size_t);
+
+	explicit operator unsigned long long() const;
+
 	string toHexString() const;
 
+	size_t hash() const;
+
 	size_t size() const;
 
 	base front() const;
@@ -81,7 +162,19 @@ class dint : private bigint
 
 	bool neg() const;
 
-	void random(int size, std::uniform_int_distribution<base> distr, std::mt19937 gen);
+	void random(int size, std::uniform_int_distribution<base> &distr, std::mt19937 &gen);
+
+	template <class generator>
+	void random_bits(size_t, generator &);
+
+	template <class generator>
+	void random_exact_bits(size_t, generator &);
+
+	template <class generator>
+	void random_below(const dint &, generator &);
+
+	template <class generator>
+	static void random_bits(span<dint>, size_t, generator &);
 
   private:
 	// data represents the integer in words of size base
@@ -94,20 +187,135 @@ class dint : private bigint
 
 	void remove_leading_zeros();
 
+	// Numbers of at most this many words fit in a machine word and take the native fast paths
+	static constexpr size_t word_size = sizeof(uint64_t) / sizeof(base);
+
+	static uint64_t load_word(const base *, size_t);
+	static void store_word(base *, uint64_t, size_t);
+
+	static uint64_t get_word(const container &);
+	void set_word(uint64_t, uint64_t = 0);
+
+	static void add_word(const dint &, const dint &, dint &);
+	static void mul_word(const container &, uint64_t, container &);
+	static uint64_t div_word(const container &, uint64_t, container &);
+
 	void shiftwordsright(size_t);
 	void shiftwordsleft(size_t);
 
 	static void karatsuba(const const_iterator &, const const_iterator &, const const_iterator &,
 						  const const_iterator &, iterator, iterator, const iterator &, const iterator &, size_t);
 
+	static void multabs(const dint &, const dint &, dint &);
+	static void mullowabs(const dint &, const dint &, size_t, dint &);
+	static void mulhighabs(const dint &, const dint &, size_t, dint &);
+	static dint slice(const dint &, size_t, size_t);
+
 	static void add(const container &a, const container &b, container &dest, const bool incr);
 
 	static void sub(const container &a, const container &b, container &dest, const bool incr);
 
+	template <class operation>
+	static void bitwise(const dint &, const dint &, dint &, operation);
+
+	static void divabs(const dint &, const dint &, dint &, dint &);
+
+	struct cofactors;
+
+	static void subabs(const dint &, const dint &, dint &);
+	static bool apply_inverse(const cofactors &, dint &, dint &);
+	static void euclid_step(dint &, dint &, cofactors *);
+	static bool lehmer_step(dint &, dint &, cofactors *);
+	static void hgcd(dint &, dint &, cofactors &);
+	static void reduce(dint &, dint &, cofactors *);
+
+	static vector<uint64_t> to_words(const dint &, size_t);
+	static dint from_words(const vector<uint64_t> &);
+
+	static int compare_words(const base *, const base *, size_t);
+	static int compare_abs(const dint &, const dint &);
 	static bool absgrt(const dint &, const dint &);
 	static bool abslst(const dint &, const dint &);
 };
 
 extern const dint &Nil;
 
-} // namespace bigint
\ No newline at end of file
+/**
+ * @brief the value of the n words at p
+ *
+ * @pre{n <= word_size}
+ */
+inline uint64_t dint::load_word(const base *p, size_t n)
+{
+	uint64_t r = 0;
+
+	if constexpr (std::endian::native == std::endian::little && sizeof(base) == 1)
+	{
+		memcpy(&r, p, n);
+	}
+	else
+	{
+		for (size_t i = n; i-- > 0;)
+		{
+			r = (r << bits_per_word) | p[i];
+		}
+	}
+
+	return r;
+}
+
+/**
+ * @brief writes the lowest n words of x to p
+ *
+ * @pre{n <= word_size}
+ */
+inline void dint::store_word(base *p, uint64_t x, size_t n)
+{
+	if constexpr (std::endian::native == std::endian::little && sizeof(base) == 1)
+	{
+		memcpy(p, &x, n);
+	}
+	else
+	{
+		for (size_t i = 0; i < n; i++, x >>= bits_per_word)
+		{
+			p[i] = static_cast<base>(x);
+		}
+	}
+}
+
+bool is_probable_prime(const dint &, int rounds = 0);
+dint random_prime(size_t, std::mt19937 &);
+
+vector<vector<dint>> product_tree(span<const dint>, size_t threads = 1);
+vector<dint> remainder_tree(const dint &, const vector<vector<dint>> &, size_t threads = 1);
+vector<dint> remainder_tree(const dint &, span<const dint>, size_t threads = 1);
+vector<dint> batch_gcd(span<const dint>, size_t threads = 1);
+
+string to_string(const dint &);
+
+dint read_hex(const digit_source &);
+dint read_decimal(const digit_source &);
+void write_hex(const dint &, const digit_sink &);
+void write_decimal(const dint &, const digit_sink &);
+
+digit_source istream_source(istream &);
+digit_source fd_source(int);
+digit_sink ostream_sink(ostream &);
+digit_sink fd_sink(int);
+
+} // namespace bigint
+
+template <>
+struct std::hash<bigint::dint>
+{
+	size_t operator()(const bigint::dint &a) const noexcept
+	{
+		return a.hash();
+	}
+};
+
+// Lets callers outside addition.cpp inline the addition and substraction loops
+#ifdef BIGINT_INLINE_KERNELS
+#include "kernels.h"
+#endif
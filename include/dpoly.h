@@ -0,0 +1,72 @@
+#pragma once
+
+#include "dint.h"
+
+namespace bigint
+{
+/**
+ * @brief A polynomial with dint coefficients, stored from the constant term up.
+ * Two polynomials are multiplied with one product of dints by Kronecker substitution: the coefficients are packed
+ * into a single number in slots wide enough for every coefficient of the result, multiplied with mult, and unpacked.
+ * The functions that take a modulus work on the coefficients modulo it, which keeps them small, and return
+ * coefficients in [0, modulus). There large divisions use a Newton inverse of the reversed divisor, so they cost a few
+ * products as well, and many points are evaluated at once by a remainder tree of the polynomials x - x_i.
+ * Over the integers the divisor has to have a leading coefficient of 1 or -1.
+ */
+class dpoly
+{
+  public:
+	dpoly() = default;
+	dpoly(vector<dint>);
+
+	// -1 for the zero polynomial
+	long long degree() const;
+	bool is_zero() const;
+
+	// The coefficient of x^i, 0 past the degree
+	const dint &operator[](size_t) const;
+	const vector<dint> &coefficients() const;
+
+	dint evaluate(const dint &) const;
+	dint evaluate(const dint &, const dint &modulus) const;
+
+	vector<dint> evaluate(span<const dint>, size_t threads = 1) const;
+	vector<dint> evaluate(span<const dint>, const dint &modulus, size_t threads = 1) const;
+
+	string toHexString() const;
+
+	dpoly operator-() const;
+
+	dpoly &operator+=(const dpoly &);
+	dpoly &operator-=(const dpoly &);
+	dpoly &operator*=(const dpoly &);
+
+	friend dpoly operator+(const dpoly &, const dpoly &);
+	friend dpoly operator-(const dpoly &, const dpoly &);
+	friend dpoly operator*(const dpoly &, const dpoly &);
+
+	friend bool operator==(const dpoly &, const dpoly &);
+
+	friend void divrem(const dpoly &, const dpoly &, dpoly &, dpoly &);
+
+	friend dpoly mod(const dpoly &, const dint &);
+	friend dpoly mulmod(const dpoly &, const dpoly &, const dint &);
+	friend void divrem(const dpoly &, const dpoly &, dpoly &, dpoly &, const dint &);
+
+  private:
+	// No trailing zeros, empty for the zero polynomial
+	vector<dint> c;
+
+	void normalize();
+
+	static dint pack(const vector<dint> &, size_t);
+	static vector<dint> unpack(const dint &, size_t, size_t);
+
+	static dpoly multiply(const dpoly &, const dpoly &, const dint *);
+	static dpoly truncated(const dpoly &, size_t);
+	static dpoly reversed(const dpoly &, size_t);
+	static dpoly inverse(const dpoly &, size_t, const dint *);
+	static void divide(const dpoly &, const dpoly &, dpoly &, dpoly &, const dint *);
+	static vector<dint> descend(const dpoly &, span<const dint>, const dint &, size_t);
+};
+} // namespace bigint
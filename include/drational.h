@@ -0,0 +1,61 @@
+#pragma once
+
+#include "dfloat.h"
+
+namespace bigint
+{
+/**
+ * @brief A fraction of two dints that is reduced to lowest terms only when needed.
+ * Sums and products of small fractions are cross multiplied without any gcd. Comparing, printing and asking for the
+ * numerator or denominator reduce a copy, canonicalize reduces the fraction itself, and results that would grow past
+ * tuning.rational words are reduced.
+ * Results past that size are computed from the reduced operands with Henrici's method, which takes the gcds of the
+ * smaller parts instead of the gcd of the whole result, and stay reduced.
+ */
+class drational
+{
+  public:
+	drational() = default;
+	drational(const dint &, const dint &denominator = dint{1ULL});
+
+	// In lowest terms, the denominator is positive. A fraction that is not reduced yet is reduced into a copy.
+	dint numerator() const;
+	dint denominator() const;
+
+	void canonicalize();
+	bool is_canonical() const;
+
+	dfloat to_dfloat(size_t precision = dfloat::default_precision) const;
+
+	string toHexString() const;
+
+	drational operator-() const;
+
+	drational &operator+=(const drational &);
+	drational &operator-=(const drational &);
+	drational &operator*=(const drational &);
+	drational &operator/=(const drational &);
+
+	friend drational operator+(const drational &, const drational &);
+	friend drational operator-(const drational &, const drational &);
+	friend drational operator*(const drational &, const drational &);
+	friend drational operator/(const drational &, const drational &);
+
+	friend int compare(const drational &, const drational &);
+	friend bool operator==(const drational &, const drational &);
+	friend strong_ordering operator<=>(const drational &, const drational &);
+
+  private:
+	// Only the non-const members reduce in place, so a const drational can be read from several threads
+	dint num;
+	dint den{1ULL};
+	bool canonical{true};
+
+	bool too_big(size_t) const;
+
+	static const drational &reduced(const drational &, drational &);
+
+	static drational add(const drational &, const drational &, bool);
+	static drational multiply(const drational &, const drational &, bool);
+};
+} // namespace bigint
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "dint.h"
+
+namespace bigint
+{
+/**
+ * @brief Packed storage for many numbers: the words of all of them in one buffer, with an offset and a sign per number.
+ * Sorting it touches one contiguous buffer instead of a heap allocation per number.
+ */
+class flat_dint_array
+{
+  public:
+	flat_dint_array() = default;
+	explicit flat_dint_array(span<const dint>);
+
+	void push_back(const dint &);
+
+	size_t size() const;
+
+	dint operator[](size_t) const;
+
+	// The words of number i, least significant first
+	span<const base> words(size_t) const;
+	bool negative(size_t) const;
+
+	vector<dint> to_dints() const;
+
+	void sort(size_t threads = 1);
+
+	friend void sort_dints(span<dint>, size_t);
+
+  private:
+	container limbs;
+	vector<size_t> offsets{0};
+	vector<bool> signs;
+
+	// A number to sort, where its words are and where it came from
+	struct item
+	{
+		const base *words;
+		size_t size;
+		bool negative;
+		size_t index;
+	};
+
+	static void sort_items(vector<item> &, size_t);
+	static void radix(item *, item *, item *, size_t);
+};
+
+void sort_dints(span<dint>, size_t threads = 1);
+} // namespace bigint
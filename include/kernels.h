@@ -0,0 +1,89 @@
+#pragma once
+
+// The definitions of the addition and substraction loops of bigint.
+// Included by addition.cpp, which instantiates them for the containers,
+// and by dint.h when BIGINT_INLINE_KERNELS is defined so that every caller can inline them.
+
+namespace bigint
+{
+template <class const_iterator, class iterator>
+requires std::input_iterator<const_iterator> && std::forward_iterator<iterator>
+bool bigint::additer(const const_iterator &big_begin, const const_iterator &big_end, const const_iterator &small_begin,
+					 const const_iterator &small_end, const iterator &dest_begin, const iterator &dest_end,
+					 const bool increment)
+{
+
+	// Initialize the iterators
+	auto pbig	= const_iterator{big_begin};
+	auto psmall = const_iterator{small_begin};
+	auto pdest	= iterator{dest_begin};
+
+	base t;
+	// Initialize the carry bit (can be one initially)
+	base c = increment ? 1 : 0;
+
+	// First part of calculation, both numbers contribute to the result
+	for (; psmall != small_end; ++pbig, ++psmall, ++pdest)
+	{
+
+		t	   = *pbig;
+		*pdest = t + *psmall + c;
+		c	   = (*pdest >= t + c ? 0 : 1);
+	}
+
+	bool self{big_begin == dest_begin};
+
+	// Second part of the calculation, only one number contributes to the result
+	for (; pbig != big_end && (c == 1 || !self); ++pbig, ++pdest)
+	{
+
+		*pdest = *pbig + c;
+		c	   = (*pdest >= c ? 0 : 1);
+	}
+
+	BIGINT_STAT(counters.additer++; counters.additer_limbs += distance(big_begin, pbig);)
+
+	// Return weither or not there was overflow.
+	return c == 1 && pbig == big_end;
+}
+
+template <class const_iterator, class iterator>
+requires std::input_iterator<const_iterator> && std::forward_iterator<iterator>
+bool bigint::subiter(const const_iterator &big_begin, const const_iterator &big_end, const const_iterator &small_begin,
+					 const const_iterator &small_end, const iterator &dest_begin, const iterator &dest_end,
+					 const bool increment)
+{
+	// Initialize the iterators
+	auto pbig	= const_iterator{big_begin};
+	auto psmall = const_iterator{small_begin};
+	auto pdest	= iterator{dest_begin};
+
+	base t;
+	// Initialize the carry bit (can be one initially)
+	base c = increment ? 1 : 0;
+
+	// First part of calculation, both numbers contribute to the result
+	for (; psmall != small_end; ++pbig, ++psmall, ++pdest)
+	{
+		t	   = *pbig;
+		*pdest = t - *psmall - c;
+
+		c = (*pdest <= t - c ? 0 : 1);
+	}
+
+	bool self{big_begin == dest_begin};
+
+	// Second part of the calculation, only one number contributes to the result
+	for (; pbig != big_end && (c == 1 || !self); ++pbig, ++pdest)
+	{
+		t	   = *pbig;
+		*pdest = t - c;
+		c	   = (t < c ? 1 : 0);
+	}
+
+	BIGINT_STAT(counters.subiter++; counters.subiter_limbs += distance(big_begin, pbig);)
+
+	// Return weither or not there was underflow.
+	return c == 1 && pbig == big_end;
+}
+} // namespace bigint
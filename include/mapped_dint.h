@@ -0,0 +1,75 @@
+#pragma once
+
+#include "dint.h"
+
+namespace bigint
+{
+/**
+ * @brief The magnitude of a number in a file, mapped into memory: the words from the least significant up, as in a
+ * dint, without anything before or after them. Numbers larger than the memory of the machine are multiplied by the mult
+ * below, which keeps only a caller chosen number of bytes of them in memory at a time.
+ */
+class mapped_dint
+{
+  public:
+	// Maps an existing file
+	explicit mapped_dint(const string &path, bool writable = false);
+
+	// Creates the file, or empties an existing one, and writes the words of |a| to it
+	mapped_dint(const string &path, const dint &a);
+
+	mapped_dint(mapped_dint &&) noexcept;
+	mapped_dint &operator=(mapped_dint &&) noexcept;
+	~mapped_dint();
+
+	mapped_dint(const mapped_dint &)			= delete;
+	mapped_dint &operator=(const mapped_dint &) = delete;
+
+	size_t size() const;
+
+	const base *data() const;
+	base *data();
+
+	// Grows or shrinks the file, new words are 0
+	void resize(size_t);
+
+	dint to_dint() const;
+
+	friend void mult(const mapped_dint &, const mapped_dint &, mapped_dint &, size_t);
+
+  private:
+	string path;
+	int fd{-1};
+	base *p{nullptr};
+	size_t n{0};
+	bool writable{false};
+
+	explicit mapped_dint(int);
+
+	void map(size_t);
+	void unmap();
+
+	// How the words are streamed, in tiles of at most tile words
+	struct schedule
+	{
+		size_t tile;
+		string directory;
+	};
+
+	static mapped_dint scratch(const schedule &, size_t);
+
+	static void advise(const base *, size_t, int);
+
+	static void load(const base *, size_t, dint &);
+	static void store(const dint &, base *, size_t);
+
+	static void fill_zero(base *, size_t, const schedule &);
+	static void copy(const base *, size_t, base *, size_t, const schedule &);
+	static bool accumulate(base *, size_t, const base *, size_t, bool, const schedule &);
+
+	static void multiply(const base *, size_t, const base *, size_t, base *, const schedule &);
+	static void karatsuba(const base *, const base *, size_t, base *, const schedule &);
+};
+
+void mult(const mapped_dint &, const mapped_dint &, mapped_dint &, size_t memory);
+} // namespace bigint
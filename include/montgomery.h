@@ -0,0 +1,55 @@
+#pragma once
+
+#include "dint.h"
+
+namespace bigint
+{
+/**
+ * @brief Arithmetic modulo an odd number in Montgomery form x R mod N, with R = 2^(64 n).
+ * The numbers are stored in 64 bit words so the products use the full width of the machine multiplier,
+ * and a reduction is n^2 multiply-adds instead of a division.
+ * The const members only read the context, so one context can be used from several threads at once.
+ */
+class montgomery
+{
+  public:
+	using word	= uint64_t;
+	using words = vector<word>;
+
+	explicit montgomery(const dint &);
+
+	words to(const dint &) const;
+	dint from(const words &) const;
+
+	void mul(const words &, const words &, words &) const;
+	void add(const words &, const words &, words &) const;
+	void sub(const words &, const words &, words &) const;
+	void half(words &) const;
+
+	words pow(const words &, const dint &) const;
+
+	const words &one() const;
+	const words &zero() const;
+
+	const dint &modulus() const;
+
+  private:
+	dint mod;
+
+	// The modulus in words
+	words N;
+
+	// -N^-1 mod 2^64
+	word ninv;
+
+	// Number of words
+	size_t n;
+
+	// R mod N and 0
+	words r1;
+	words r0;
+
+	bool geq_modulus(const words &) const;
+	void sub_modulus(words &) const;
+};
+} // namespace bigint
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "dint.h"
+
+namespace bigint
+{
+/**
+ * @brief Numbers as their residues modulo a fixed set of primes just below 2^62, one machine word per prime.
+ * Addition, substraction and multiplication work on every prime on its own, without carries between them,
+ * so a long chain of operations costs a few word operations per prime and the number is converted back once.
+ * A number is converted in with a remainder per prime and back with the Chinese remainder theorem on the product tree.
+ * The residues are kept in Montgomery form x 2^64 mod p.
+ */
+class multimodular
+{
+  public:
+	using word	   = unsigned long long;
+	using residues = vector<word>;
+
+	explicit multimodular(size_t bits);
+
+	residues to(const dint &, size_t threads = 1) const;
+	dint from(const residues &, size_t threads = 1) const;
+
+	void add(const residues &, const residues &, residues &) const;
+	void sub(const residues &, const residues &, residues &) const;
+	void mul(const residues &, const residues &, residues &) const;
+
+	size_t size() const;
+
+	const vector<word> &primes() const;
+	const dint &modulus() const;
+
+  private:
+	vector<word> p;
+
+	// -p^-1 mod 2^64
+	vector<word> pinv;
+
+	// 2^128 mod p, to go into Montgomery form
+	vector<word> r2;
+
+	// (M / p)^-1 mod p, where M is the product of all primes
+	vector<word> crt;
+
+	// product_tree of the primes, its root is M
+	vector<vector<dint>> tree;
+
+	// M / 2, the numbers from it up stand for negative numbers
+	dint half;
+};
+} // namespace bigint
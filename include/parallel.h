@@ -0,0 +1,77 @@
+#pragma once
+
+#include "common.h"
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace bigint
+{
+using namespace std;
+
+/**
+ * @brief Calls f(i) for every i below n, spread over a number of threads that take the next i when they are done.
+ * The calling thread is one of them. The first exception thrown by f is thrown again after all threads are done.
+ *
+ * @param n
+ * @param threads the number of threads to use, 0 for all the hardware has
+ * @param f
+ */
+template <class function>
+void parallel_for(size_t n, size_t threads, const function &f)
+{
+	if (threads == 0)
+	{
+		threads = max(thread::hardware_concurrency(), 1u);
+	}
+
+	atomic<size_t> next{0};
+
+	exception_ptr error;
+	mutex error_lock;
+
+	auto work = [&]()
+	{
+		try
+		{
+			for (size_t i; (i = next++) < n;)
+			{
+				f(i);
+			}
+		}
+		catch (...)
+		{
+			lock_guard<mutex> lock{error_lock};
+
+			if (!error)
+			{
+				error = current_exception();
+			}
+
+			// The other threads stop at their next i
+			next = n;
+		}
+	};
+
+	vector<thread> pool;
+
+	for (size_t t = 1; t < min(threads, n); t++)
+	{
+		pool.emplace_back(work);
+	}
+
+	work();
+
+	for (thread &t : pool)
+	{
+		t.join();
+	}
+
+	if (error)
+	{
+		rethrow_exception(error);
+	}
+}
+} // namespace bigint
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common.h"
+
+namespace bigint
+{
+/**
+ * @brief Philox4x32-10 counter based random number generator (Salmon et al., Parallel random numbers: as easy as 1, 2, 3).
+ * Every output is a function of (key, counter) only, so independent streams need no shared state
+ * and jumping ahead is free, which makes it suitable for generating in parallel.
+ * Satisfies std::uniform_random_bit_generator with 64 bit results.
+ */
+class philox
+{
+  public:
+	using result_type = uint64_t;
+
+	explicit philox(uint64_t seed = 0, uint64_t stream = 0);
+
+	static constexpr result_type min()
+	{
+		return 0;
+	}
+
+	static constexpr result_type max()
+	{
+		return numeric_limits<result_type>::max();
+	}
+
+	result_type operator()();
+
+	void discard(unsigned long long);
+
+	static array<uint32_t, 4> block(const array<uint32_t, 4> &, const array<uint32_t, 2> &);
+
+  private:
+	array<uint32_t, 2> key;
+
+	// Low 64 bits count the blocks, high 64 bits are the stream
+	array<uint32_t, 4> counter;
+
+	// The current block and the next 64 bit half of it to return
+	array<uint32_t, 4> buffer;
+	unsigned int index;
+
+	void next_block();
+};
+} // namespace bigint
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "common.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+namespace bigint
+{
+using namespace std;
+
+/**
+ * @brief Thrown out of an operation at its next checkpoint after its cancellation_token was cancelled.
+ */
+class operation_cancelled : public runtime_error
+{
+  public:
+	operation_cancelled() : runtime_error("operation cancelled") {}
+};
+
+/**
+ * @brief A flag shared by all its copies. Cancelling one copy cancels the operations that were given any of them.
+ */
+class cancellation_token
+{
+  public:
+	void cancel() const
+	{
+		flag->store(true, memory_order_relaxed);
+	}
+
+	bool cancelled() const
+	{
+		return flag->load(memory_order_relaxed);
+	}
+
+  private:
+	shared_ptr<atomic<bool>> flag{make_shared<atomic<bool>>(false)};
+};
+
+/**
+ * @brief The long operation running on the calling thread, to which the loops of the library report their work.
+ * Karatsuba reports at its leaves, division per quotient word and Montgomery multiplication per product, all in
+ * products of words. At every report the token is checked and the callback gets the fraction of the estimated total
+ * done, at most once per step of that fraction and never more than 1.
+ * Progress objects nest, only the innermost one on a thread is reported to.
+ */
+class progress
+{
+  public:
+	progress(cancellation_token, function<void(double)>, uint64_t total, double step = 0.01);
+	~progress();
+
+	progress(const progress &)			  = delete;
+	progress &operator=(const progress &) = delete;
+
+	void work(uint64_t);
+
+	// Reports 1
+	void finish();
+
+	// Reports work to the progress of the calling thread, if it has one
+	static void checkpoint(uint64_t words)
+	{
+		if (current)
+		{
+			current->work(words);
+		}
+	}
+
+  private:
+	static thread_local progress *current;
+
+	progress *previous;
+
+	cancellation_token token;
+	function<void(double)> callback;
+
+	uint64_t total;
+	uint64_t done{0};
+
+	// The callback is called again when done reaches next
+	uint64_t next{0};
+	uint64_t step;
+};
+} // namespace bigint
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "common.h"
+
+namespace bigint
+{
+using namespace std;
+
+/**
+ * @brief Counters of the work the library did on one thread.
+ * They are only kept when the library is built with BIGINT_STATS, otherwise they stay 0.
+ * Every thread has its own counters, so counting needs no synchronisation.
+ */
+struct stats
+{
+	enum operation
+	{
+		add,
+		sub,
+		mul,
+		div,
+		gcd,
+		shift,
+		operations
+	};
+
+	// Histogram bucket i counts the operands with bit_width(words) == i
+	static constexpr size_t buckets = 40;
+
+	// Calls per operation
+	array<uint64_t, operations> calls{};
+
+	// Sizes of the biggest operand per operation
+	array<array<uint64_t, buckets>, operations> sizes{};
+
+	// Calls of karatsuba and the deepest recursion seen
+	uint64_t karatsuba{};
+	uint64_t karatsuba_depth{};
+
+	// Schoolbook products at the leaves, with the number of word products they did
+	uint64_t basicmult{};
+	uint64_t basicmult_limbs{};
+
+	// Calls of the addition and substraction loops, with the number of words they went through
+	uint64_t additer{};
+	uint64_t additer_limbs{};
+	uint64_t subiter{};
+	uint64_t subiter_limbs{};
+
+	// Allocations of number storage, the live bytes can be negative if memory moved to another thread
+	uint64_t allocations{};
+	uint64_t allocated_bytes{};
+	uint64_t deallocations{};
+	int64_t live_bytes{};
+	int64_t peak_bytes{};
+
+	// The current karatsuba recursion depth
+	uint64_t depth{};
+
+	void count(operation op, size_t words)
+	{
+		calls[op]++;
+		sizes[op][min(static_cast<size_t>(bit_width(words)), buckets - 1)]++;
+	}
+
+	void allocated(size_t bytes)
+	{
+		allocations++;
+		allocated_bytes += bytes;
+		live_bytes += static_cast<int64_t>(bytes);
+		peak_bytes = max(peak_bytes, live_bytes);
+	}
+
+	void deallocated(size_t bytes)
+	{
+		deallocations++;
+		live_bytes -= static_cast<int64_t>(bytes);
+	}
+
+	stats &operator+=(const stats &);
+
+	void write(ostream &) const;
+};
+
+// A copy of the counters of the calling thread
+stats snapshot();
+
+// Sets the counters of the calling thread to 0
+void reset();
+
+#ifdef BIGINT_STATS
+
+extern thread_local stats counters;
+
+// Counts the work of the karatsuba call it lives in
+struct karatsuba_frame
+{
+	karatsuba_frame()
+	{
+		counters.karatsuba++;
+		counters.karatsuba_depth = max(counters.karatsuba_depth, ++counters.depth);
+	}
+
+	~karatsuba_frame()
+	{
+		counters.depth--;
+	}
+};
+
+#define BIGINT_STAT(...) __VA_ARGS__
+
+#else
+
+#define BIGINT_STAT(...)
+
+#endif
+} // namespace bigint
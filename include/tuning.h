@@ -0,0 +1,52 @@
+#pragma once
+
+#include "common.h"
+
+// Written by make tune for the machine it ran on
+#if __has_include("thresholds.h")
+#include "thresholds.h"
+#endif
+
+// Below this many words multiplication is done with the schoolbook method instead of Karatsuba
+#ifndef BIGINT_MUL_THRESHOLD
+#define BIGINT_MUL_THRESHOLD 12
+#endif
+
+// From this many words the gcd uses the half gcd instead of Lehmer steps
+#ifndef BIGINT_HGCD_THRESHOLD
+#define BIGINT_HGCD_THRESHOLD 1000
+#endif
+
+// From this many words in the numerator and denominator together a drational is reduced to lowest terms
+#ifndef BIGINT_RATIONAL_THRESHOLD
+#define BIGINT_RATIONAL_THRESHOLD 256
+#endif
+
+namespace bigint
+{
+using namespace std;
+
+/**
+ * @brief The crossover points between algorithms, in words.
+ * They start at the values of the generated thresholds.h, or the defaults above,
+ * and are then read from the file in the environment variable BIGINT_THRESHOLDS if it is set.
+ * A file that can not be read is reported on cerr and ignored, so it does not stop programs before main.
+ */
+struct thresholds
+{
+	size_t mul{BIGINT_MUL_THRESHOLD};
+	size_t hgcd{BIGINT_HGCD_THRESHOLD};
+	size_t rational{BIGINT_RATIONAL_THRESHOLD};
+
+	void load(const string &);
+	void save(const string &) const;
+
+	// The defaults with the file in BIGINT_THRESHOLDS read over them, or only the defaults if it can not be read
+	static thresholds from_environment();
+
+	string header() const;
+};
+
+// The thresholds used by the library, can be changed at run time
+extern thresholds tuning;
+} // namespace bigint
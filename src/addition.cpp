@@ -1,46 +1,8 @@
 #include "dint.h"
+#include "kernels.h"
 
 namespace bigint
 {
-template <class const_iterator, class iterator>
-requires std::input_iterator<const_iterator> && std::forward_iterator<iterator>
-bool bigint::additer(const const_iterator &big_begin, const const_iterator &big_end, const const_iterator &small_begin,
-					 const const_iterator &small_end, const iterator &dest_begin, const iterator &dest_end,
-					 const bool increment)
-{
-
-	// Initialize the iterators
-	auto pbig	= const_iterator{big_begin};
-	auto psmall = const_iterator{small_begin};
-	auto pdest	= iterator{dest_begin};
-
-	base t;
-	// Initialize the carry bit (can be one initially)
-	base c = increment ? 1 : 0;
-
-	// First part of calculation, both numbers contribute to the result
-	for (; psmall != small_end; ++pbig, ++psmall, ++pdest)
-	{
-
-		t	   = *pbig;
-		*pdest = t + *psmall + c;
-		c	   = (*pdest >= t + c ? 0 : 1);
-	}
-
-	bool self{big_begin == dest_begin};
-
-	// Second part of the calculation, only one number contributes to the result
-	for (; pbig != big_end && (c == 1 || !self); ++pbig, ++pdest)
-	{
-
-		*pdest = *pbig + c;
-		c	   = (*pdest >= c ? 0 : 1);
-	}
-
-	// Return weither or not there was overflow.
-	return c == 1 && pbig == big_end;
-}
-
 template bool bigint::additer<container::const_iterator, container::iterator>(
 	const container::const_iterator &, const container::const_iterator &, const container::const_iterator &,
 	const container::const_iterator &, const container::iterator &, const container::iterator &, const bool);
@@ -63,84 +25,17 @@ template bool bigint::additer<container::iterator, container::iterator>(
  */
 void dint::add(const container &big, const container &small, container &dest, const bool increment = false)
 {
+	BIGINT_STAT(counters.count(stats::add, big.size());)
+
 	if (additer(big.cbegin(), big.cend(), small.cbegin(), small.cend(), dest.begin(), dest.end(), increment))
 	{
 		dest.push_back(base{1});
 	}
 }
 
-template <class const_iterator, class iterator>
-bool bigint::subiter(const const_iterator &big_begin, const const_iterator &big_end, const const_iterator &small_begin,
-					 const const_iterator &small_end, const iterator &dest_begin, const iterator &dest_end,
-					 iterator *pzeros, const bool increment)
-{
-	// Initialize the iterators
-	auto pbig	= container::const_iterator{big_begin};
-	auto psmall = container::const_iterator{small_begin};
-	auto pdest	= container::iterator{dest_begin};
-
-	bool zeros = false;
-
-	const bool check_zero(pzeros != nullptr);
-
-	base t;
-	// Initialize the carry bit (can be one initially)
-	base c = increment ? 1 : 0;
-
-	// First part of calculation, both numbers contribute to the result
-	for (; psmall != small_end; ++pbig, ++psmall, ++pdest)
-	{
-		t	   = *pbig;
-		*pdest = *pbig - *psmall - c;
-
-		c = (*pdest <= t - c ? 0 : 1);
-
-		if (check_zero)
-		{
-			if (*pdest == 0)
-			{
-				if (!zeros)
-				{
-					*pzeros = pdest;
-					zeros	= true;
-				}
-			}
-			else
-			{
-				zeros = false;
-			}
-		}
-	}
-
-	bool self{big_begin == dest_begin};
-
-	// Second part of the calculation, only one number contributes to the result
-	for (; pbig != big_end && (c == 1 || !self); ++pbig, ++pdest)
-	{
-		t = *pdest;
-		*pdest -= c;
-		c = (t == 0 ? 1 : 0);
-
-		if (check_zero)
-		{
-			if (*pdest == 0)
-			{
-				if (!zeros)
-				{
-					*pzeros = pdest;
-					zeros	= true;
-				}
-			}
-			else
-			{
-				zeros = false;
-			}
-		}
-	}
-
-	// Return weither or not there was underflow.
-	return c == 1 && pbig == big_end;
-}
+template bool bigint::subiter<container::const_iterator, container::iterator>(
+	const container::const_iterator &, const container::const_iterator &, const container::const_iterator &,
+	const container::const_iterator &, const container::iterator &, const container::iterator &, const bool);
 
 /**
  * @brief substracts b from a.
@@ -156,11 +51,40 @@ bool bigint::subiter(const const_iterator &big_begin, const const_iterator &big_
  */
 void dint::sub(const container &big, const container &small, container &dest, const bool increment = false)
 {
-	container::iterator *pzero = new container::iterator{};
+	BIGINT_STAT(counters.count(stats::sub, big.size());)
+
+	subiter(big.cbegin(), big.cend(), small.cbegin(), small.cend(), dest.begin(), dest.end(), increment);
+
+	// Only the words that cancelled at the top can be zero, so this stops at the first non-zero word from the top
+	size_t n = dest.size();
+
+	while (n > 1 && dest[n - 1] == 0)
+	{
+		n--;
+	}
+
+	dest.resize(n);
+}
+
+/**
+ * @brief substracts the absolute values
+ *
+ * @param big
+ * @param small
+ * @param dest the result will go into this dint, may be big or small
+ * @pre{|big| >= |small|}
+ * @post{dest = |big| - |small|}
+ */
+void dint::subabs(const dint &big, const dint &small, dint &dest)
+{
+	container res{big.data};
 
-	subiter(big.cbegin(), big.cend(), small.cbegin(), small.cend(), dest.begin(), dest.end(), pzero, increment);
+	subiter(static_cast<const_iterator>(res.begin()), static_cast<const_iterator>(res.end()), small.data.cbegin(),
+			small.data.cend(), res.begin(), res.end(), false);
 
-	dest.erase(*pzero, dest.end());
+	dest.data	  = move(res);
+	dest.negative = false;
+	dest.remove_leading_zeros();
 }
 
 /**
@@ -173,6 +97,7 @@ dint &dint::operator++()
 	if (negative)
 	{
 		sub(move(this->data), move(Nil.data), this->data, true);
+		negative = !(size() == 1 && data[0] == 0);
 	}
 	else
 	{
@@ -188,16 +113,16 @@ dint &dint::operator++()
  */
 dint &dint::operator--()
 {
-	if (!negative)
+	if (!negative && !(size() == 1 && data[0] == 0))
 	{
 		sub(move(this->data), move(Nil.data), this->data, true);
 	}
 	else
 	{
 		add(move(this->data), move(Nil.data), this->data, true);
+		negative = true;
 	}
 	return *this;
-	return *this;
 }
 
 /**
@@ -224,6 +149,36 @@ dint dint::operator--(int)
 	return tmp;
 }
 
+/**
+ * @brief adds b to a when both fit in a machine word
+ *
+ * @param a
+ * @param b
+ * @param dest the result will go into this dint, may be a or b
+ * @pre{a.size() <= word_size && b.size() <= word_size}
+ */
+void dint::add_word(const dint &a, const dint &b, dint &dest)
+{
+	BIGINT_STAT(counters.count(a.negative == b.negative ? stats::add : stats::sub, word_size);)
+
+	uint64_t x = get_word(a.data);
+	uint64_t y = get_word(b.data);
+
+	if (a.negative == b.negative)
+	{
+		uint64_t s;
+		bool carry = __builtin_add_overflow(x, y, &s);
+
+		dest.negative = a.negative;
+		dest.set_word(s, carry ? 1 : 0);
+	}
+	else
+	{
+		dest.negative = x >= y ? a.negative && x != y : b.negative;
+		dest.set_word(x >= y ? x - y : y - x);
+	}
+}
+
 /**
  * @brief addition of two dints
  *
@@ -233,6 +188,13 @@ dint dint::operator--(int)
  */
 dint operator+(const dint &a, const dint &b)
 {
+	if (a.size() <= dint::word_size && b.size() <= dint::word_size)
+	{
+		dint res;
+		dint::add_word(a, b, res);
+		return res;
+	}
+
 
 	size_t sa = a.data.size();
 	size_t sb = b.data.size();
@@ -247,6 +209,8 @@ dint operator+(const dint &a, const dint &b)
 	if (a.negative == b.negative)
 	{
 		// Addition
+		res.negative = a.negative;
+
 		if (sa >= sb)
 		{
 			dint::add(move(a.data), move(b.data), res.data);
@@ -259,7 +223,7 @@ dint operator+(const dint &a, const dint &b)
 	else
 	{
 		// Substraction
-		if (a > b)
+		if (!dint::abslst(a, b))
 		{
 			dint::sub(move(a.data), move(b.data), res.data);
 			res.negative = a.negative;
@@ -269,6 +233,11 @@ dint operator+(const dint &a, const dint &b)
 			dint::sub(move(b.data), move(a.data), res.data);
 			res.negative = b.negative;
 		}
+
+		if (res.size() == 1 && res.data[0] == 0)
+		{
+			res.negative = false;
+		}
 	}
 
 	return res;
@@ -308,7 +277,9 @@ dint operator-(const dint &a, const dint &b)
  */
 dint &operator-(const dint &a, dint &&b)
 {
+	// a - b = -(b - a)
 	b -= a;
+	b.negative = !b.negative && !(b.size() == 1 && b.data[0] == 0);
 	return b;
 }
 
@@ -350,6 +321,12 @@ void dint::operator+=(base x)
 
 void dint::operator+=(const dint &a)
 {
+	if (a.size() <= word_size && size() <= word_size)
+	{
+		add_word(*this, a, *this);
+		return;
+	}
+
 	// get the sizes
 	size_t sa = a.data.size();
 	size_t sb = data.size();
@@ -377,6 +354,11 @@ void dint::operator+=(const dint &a)
 		{
 			sub(move(this->data), move(a.data), this->data);
 		}
+
+		if (size() == 1 && data[0] == 0)
+		{
+			negative = false;
+		}
 	}
 }
 
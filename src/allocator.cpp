@@ -0,0 +1,166 @@
+#include "allocator.h"
+
+namespace bigint
+{
+	thread_local pmr::memory_resource *current_resource = nullptr;
+
+	arena::arena(size_t initial, pmr::memory_resource *upstream)
+		: upstream{upstream}, initial{max(initial, sizeof(block))}, next_size{this->initial}
+	{
+	}
+
+	arena::~arena()
+	{
+		release();
+	}
+
+	void arena::release()
+	{
+		while (blocks != nullptr)
+		{
+			block *b = blocks;
+			blocks	 = b->next;
+			upstream->deallocate(b, b->size, alignof(max_align_t));
+		}
+
+		p		  = nullptr;
+		end		  = nullptr;
+		bytes	  = 0;
+		next_size = initial;
+	}
+
+	size_t arena::used() const
+	{
+		return bytes;
+	}
+
+	void *arena::do_allocate(size_t n, size_t alignment)
+	{
+		auto aligned = [&]() -> char *
+		{
+			if (p == nullptr)
+			{
+				return nullptr;
+			}
+
+			char *q = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(p) + alignment - 1) & ~(alignment - 1));
+
+			return q <= end && static_cast<size_t>(end - q) >= n ? q : nullptr;
+		};
+
+		char *q = aligned();
+
+		if (q == nullptr)
+		{
+			// The blocks grow geometrically, so a long computation needs few of them
+			size_t size = max(next_size, sizeof(block) + n + alignment);
+			next_size	= size * 2;
+
+			auto b = static_cast<block *>(upstream->allocate(size, alignof(max_align_t)));
+			b->next = blocks;
+			b->size = size;
+			blocks	= b;
+
+			p	= reinterpret_cast<char *>(b + 1);
+			end = reinterpret_cast<char *>(b) + size;
+
+			q = aligned();
+		}
+
+		p = q + n;
+		bytes += n;
+
+		return q;
+	}
+
+	void arena::do_deallocate(void *, size_t, size_t)
+	{
+	}
+
+	bool arena::do_is_equal(const pmr::memory_resource &r) const noexcept
+	{
+		return this == &r;
+	}
+
+	limb_pool::limb_pool(pmr::memory_resource *upstream) : upstream{upstream}
+	{
+	}
+
+	limb_pool::~limb_pool()
+	{
+		release();
+	}
+
+	void limb_pool::release()
+	{
+		for (auto [chunk, size] : chunks)
+		{
+			upstream->deallocate(chunk, size, alignof(max_align_t));
+		}
+
+		chunks.clear();
+		free.fill(nullptr);
+	}
+
+	/**
+	 * @brief the index of the smallest class that fits n bytes
+	 *
+	 * @pre{n <= max_class}
+	 */
+	size_t limb_pool::size_class(size_t n)
+	{
+		return static_cast<size_t>(bit_width(max(n, min_class) - 1)) - (bit_width(min_class) - 1);
+	}
+
+	void *limb_pool::do_allocate(size_t n, size_t alignment)
+	{
+		if (n > max_class || alignment > min_class)
+		{
+			return upstream->allocate(n, alignment);
+		}
+
+		size_t c = size_class(n);
+
+		if (free[c] == nullptr)
+		{
+			// Carve a new chunk into blocks of this class
+			size_t block_size = min_class << c;
+			size_t size		  = max(chunk_size, block_size);
+
+			char *chunk = static_cast<char *>(upstream->allocate(size, alignof(max_align_t)));
+			chunks.emplace_back(chunk, size);
+
+			for (size_t i = size; i >= block_size; i -= block_size)
+			{
+				auto q	= reinterpret_cast<node *>(chunk + i - block_size);
+				q->next = free[c];
+				free[c] = q;
+			}
+		}
+
+		node *q = free[c];
+		free[c] = q->next;
+
+		return q;
+	}
+
+	void limb_pool::do_deallocate(void *q, size_t n, size_t alignment)
+	{
+		if (n > max_class || alignment > min_class)
+		{
+			upstream->deallocate(q, n, alignment);
+			return;
+		}
+
+		size_t c = size_class(n);
+
+		auto b	= static_cast<node *>(q);
+		b->next = free[c];
+		free[c] = b;
+	}
+
+	bool limb_pool::do_is_equal(const pmr::memory_resource &r) const noexcept
+	{
+		return this == &r;
+	}
+} // namespace bigint
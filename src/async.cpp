@@ -0,0 +1,197 @@
+#include "async.h"
+#include "tuning.h"
+
+namespace bigint
+{
+	/**
+	 * @param threads the number of threads, 0 for all the hardware has
+	 */
+	thread_pool::thread_pool(size_t threads)
+	{
+		if (threads == 0)
+		{
+			threads = max(thread::hardware_concurrency(), 1u);
+		}
+
+		for (size_t i = 0; i < threads; i++)
+		{
+			workers.emplace_back(
+				[this]
+				{
+					while (true)
+					{
+						function<void()> task;
+
+						{
+							unique_lock<mutex> l{lock};
+							ready.wait(l, [this] { return stopping || !tasks.empty(); });
+
+							if (tasks.empty())
+							{
+								return;
+							}
+
+							task = move(tasks.front());
+							tasks.pop_front();
+						}
+
+						task();
+					}
+				});
+		}
+	}
+
+	thread_pool::~thread_pool()
+	{
+		{
+			lock_guard<mutex> l{lock};
+			stopping = true;
+		}
+
+		ready.notify_all();
+
+		for (thread &t : workers)
+		{
+			t.join();
+		}
+	}
+
+	void thread_pool::execute(function<void()> task)
+	{
+		{
+			lock_guard<mutex> l{lock};
+			tasks.push_back(move(task));
+		}
+
+		ready.notify_one();
+	}
+
+	executor &default_executor()
+	{
+		static thread_pool pool;
+		return pool;
+	}
+
+	/**
+	 * @brief the word products karatsuba does on two numbers of n words, the same recursion without the work
+	 */
+	static uint64_t karatsuba_work(size_t n)
+	{
+		if (n <= tuning.mul)
+		{
+			return n * n;
+		}
+
+		return n % 2 == 1 ? karatsuba_work(n - 1) : 3 * karatsuba_work(n / 2);
+	}
+
+	/**
+	 * @brief the word products multabs reports for numbers of a and b words
+	 */
+	static uint64_t mul_work(size_t a, size_t b)
+	{
+		if (a < b)
+		{
+			swap(a, b);
+		}
+
+		if (b <= tuning.mul)
+		{
+			return a * b;
+		}
+
+		// In pieces of b words
+		return (a + b - 1) / b * karatsuba_work(b);
+	}
+
+	/**
+	 * @brief the word products division reports for numbers of a and b words
+	 */
+	static uint64_t div_work(size_t a, size_t b)
+	{
+		return a < b ? 0 : (a - b + 1) * b;
+	}
+
+	/**
+	 * @brief a b on an executor, cancelled and reported at the leaves of karatsuba
+	 */
+	async_operation<dint> async_mult(dint a, dint b, async_options options)
+	{
+		const uint64_t total = mul_work(a.size(), b.size());
+
+		return {[a = move(a), b = move(b)] { return a * b; }, total, move(options)};
+	}
+
+	/**
+	 * @brief the quotient and remainder of a by b, as divmod, on an executor
+	 */
+	async_operation<pair<dint, dint>> async_divmod(dint a, dint b, async_options options)
+	{
+		const uint64_t total = div_work(a.size(), b.size());
+
+		return {[a = move(a), b = move(b)]
+				{
+					pair<dint, dint> r;
+					divmod(a, b, r.first, r.second);
+					return r;
+				},
+				total, move(options)};
+	}
+
+	/**
+	 * @brief b^e mod m, as powmod, on an executor.
+	 * An odd modulus is reported per Montgomery product, of which there are about 1.25 per bit of the exponent,
+	 * an even one per product and division.
+	 */
+	async_operation<dint> async_powmod(dint b, dint e, dint m, async_options options)
+	{
+		const size_t n	  = m.size();
+		const size_t bits = e.bit_length();
+
+		uint64_t total;
+
+		if (m.front() % 2 == 1)
+		{
+			// 64 bit words
+			const uint64_t w = (n + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+			total			 = (bits + bits / 4 + 16) * w * w;
+		}
+		else
+		{
+			total = (bits + bits / 2) * (mul_work(n, n) + div_work(2 * n, n));
+		}
+
+		return {[b = move(b), e = move(e), m = move(m)] { return powmod(b, e, m); }, total, move(options)};
+	}
+
+	/**
+	 * @brief the decimal representation of a, as to_string, on an executor.
+	 * Reported by the divisions, which split a in halves, so they add up to about n^2 / 2 words.
+	 */
+	async_operation<string> async_to_string(dint a, async_options options)
+	{
+		const uint64_t n = a.size();
+
+		return {[a = move(a)] { return to_string(a); }, n * n / 2, move(options)};
+	}
+
+	async_operation<dint> async_mult(dint a, dint b)
+	{
+		return async_mult(move(a), move(b), async_options{});
+	}
+
+	async_operation<pair<dint, dint>> async_divmod(dint a, dint b)
+	{
+		return async_divmod(move(a), move(b), async_options{});
+	}
+
+	async_operation<dint> async_powmod(dint b, dint e, dint m)
+	{
+		return async_powmod(move(b), move(e), move(m), async_options{});
+	}
+
+	async_operation<string> async_to_string(dint a)
+	{
+		return async_to_string(move(a), async_options{});
+	}
+} // namespace bigint
@@ -0,0 +1,400 @@
+#include "dint.h"
+
+namespace bigint
+{
+	/**
+	 * @brief Combines the two's complement representations of a and b limb by limb.
+	 * The negations -x = ~x + 1 are done on the fly, so no temporary copies of the operands are made.
+	 *
+	 * @param a
+	 * @param b
+	 * @param dest the result will go into this dint, may be a or b
+	 * @param f the operation on two limbs
+	 * @pre{f(0, 0) == 0}
+	 */
+	template <class operation>
+	void dint::bitwise(const dint &a, const dint &b, dint &dest, operation f)
+	{
+		const size_t sa = a.size();
+		const size_t sb = b.size();
+
+		// One extra limb that only holds the sign extension of the operands
+		const size_t n = max(sa, sb) + 1;
+
+		container r(n);
+
+		// The carries of the negations, these stay 1 as long as all lower limbs are 0
+		base ca = a.negative ? 1 : 0;
+		base cb = b.negative ? 1 : 0;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			base x = i < sa ? a.data[i] : base{0};
+			base y = i < sb ? b.data[i] : base{0};
+
+			if (a.negative)
+			{
+				base m = x;
+				x	   = ~m + ca;
+				ca	   = (ca == 1 && m == 0) ? 1 : 0;
+			}
+
+			if (b.negative)
+			{
+				base m = y;
+				y	   = ~m + cb;
+				cb	   = (cb == 1 && m == 0) ? 1 : 0;
+			}
+
+			r[i] = f(x, y);
+		}
+
+		// The top limb is either all zeros or all ones
+		dest.negative = r.back() != 0;
+
+		if (dest.negative)
+		{
+			// Convert back to sign magnitude
+			base c = 1;
+			for (auto &i : r)
+			{
+				base m = i;
+				i	   = ~m + c;
+				c	   = (c == 1 && m == 0) ? 1 : 0;
+			}
+		}
+
+		dest.data = move(r);
+		dest.remove_leading_zeros();
+	}
+
+	/**
+	 * @brief dint with only bit i set
+	 */
+	static dint single_bit(size_t i)
+	{
+		container r(i / bits_per_word + 1, base{0});
+		r.back() = base{1} << (i % bits_per_word);
+		return dint{move(r)};
+	}
+
+	/**
+	 * @brief bitwise not, with two's complement semantics ~x = -x - 1
+	 *
+	 * @return dint
+	 */
+	dint dint::operator~() const
+	{
+		dint res{*this};
+
+		bool zero = (size() == 1 && data[0] == 0);
+
+		if (!negative || zero)
+		{
+			// ~x = -(x + 1)
+			base c = 1;
+			for (auto &i : res.data)
+			{
+				i += c;
+				c = (i == 0) ? 1 : 0;
+				if (c == 0)
+				{
+					break;
+				}
+			}
+
+			if (c == 1)
+			{
+				res.data.push_back(1);
+			}
+
+			res.negative = true;
+		}
+		else
+		{
+			// ~(-x) = x - 1
+			base c = 1;
+			for (auto &i : res.data)
+			{
+				base t = i;
+				i -= c;
+				c = (t == 0) ? 1 : 0;
+				if (c == 0)
+				{
+					break;
+				}
+			}
+
+			res.negative = false;
+			res.remove_leading_zeros();
+		}
+
+		return res;
+	}
+
+	dint &dint::operator&=(const dint &a)
+	{
+		if (negative || a.negative)
+		{
+			bitwise(*this, a, *this, bit_and<base>{});
+			return *this;
+		}
+
+		size_t m = min(size(), a.size());
+
+		data.resize(m);
+
+		for (size_t i = 0; i < m; i++)
+		{
+			data[i] &= a.data[i];
+		}
+
+		remove_leading_zeros();
+
+		return *this;
+	}
+
+	dint &dint::operator|=(const dint &a)
+	{
+		if (negative || a.negative)
+		{
+			bitwise(*this, a, *this, bit_or<base>{});
+			return *this;
+		}
+
+		size_t m = a.size();
+
+		if (size() < m)
+		{
+			data.resize(m);
+		}
+
+		for (size_t i = 0; i < m; i++)
+		{
+			data[i] |= a.data[i];
+		}
+
+		return *this;
+	}
+
+	dint &dint::operator^=(const dint &a)
+	{
+		if (negative || a.negative)
+		{
+			bitwise(*this, a, *this, bit_xor<base>{});
+			return *this;
+		}
+
+		size_t m = a.size();
+
+		if (size() < m)
+		{
+			data.resize(m);
+		}
+
+		for (size_t i = 0; i < m; i++)
+		{
+			data[i] ^= a.data[i];
+		}
+
+		remove_leading_zeros();
+
+		return *this;
+	}
+
+	dint operator&(const dint &a, const dint &b)
+	{
+		dint res{a};
+		res &= b;
+		return res;
+	}
+
+	dint operator|(const dint &a, const dint &b)
+	{
+		dint res{a};
+		res |= b;
+		return res;
+	}
+
+	dint operator^(const dint &a, const dint &b)
+	{
+		dint res{a};
+		res ^= b;
+		return res;
+	}
+
+	/**
+	 * @brief tests bit i of the two's complement representation
+	 *
+	 * @param i
+	 * @return bool
+	 */
+	bool dint::test_bit(size_t i) const
+	{
+		size_t w = i / bits_per_word;
+
+		base x = w < size() ? data[w] : base{0};
+
+		if (negative)
+		{
+			// The limb of -x is ~x + 1, where the 1 only carries into this limb if all lower limbs are 0
+			base c = 1;
+			for (size_t j = 0; j < w && j < size(); j++)
+			{
+				if (data[j] != 0)
+				{
+					c = 0;
+					break;
+				}
+			}
+			x = ~x + c;
+		}
+
+		return (x >> (i % bits_per_word)) & 1;
+	}
+
+	/**
+	 * @brief sets bit i of the two's complement representation
+	 *
+	 * @param i
+	 */
+	void dint::set_bit(size_t i)
+	{
+		if (negative)
+		{
+			operator|=(single_bit(i));
+			return;
+		}
+
+		size_t w = i / bits_per_word;
+
+		if (w >= size())
+		{
+			data.resize(w + 1);
+		}
+
+		data[w] |= base{1} << (i % bits_per_word);
+	}
+
+	/**
+	 * @brief clears bit i of the two's complement representation
+	 *
+	 * @param i
+	 */
+	void dint::clear_bit(size_t i)
+	{
+		if (negative)
+		{
+			operator&=(~single_bit(i));
+			return;
+		}
+
+		size_t w = i / bits_per_word;
+
+		if (w < size())
+		{
+			data[w] &= ~(base{1} << (i % bits_per_word));
+			remove_leading_zeros();
+		}
+	}
+
+	/**
+	 * @brief number of bits needed to represent the absolute value
+	 *
+	 * @return size_t 0 for 0
+	 */
+	size_t dint::bit_length() const
+	{
+		if (size() == 1 && data[0] == 0)
+		{
+			return 0;
+		}
+
+		return (size() - 1) * bits_per_word + bit_width(data.back());
+	}
+
+	/**
+	 * @brief number of set bits in the absolute value
+	 *
+	 * @return size_t
+	 */
+	size_t dint::popcount() const
+	{
+		size_t n = size();
+		size_t i = 0;
+		size_t r = 0;
+
+		for (; i + word_size <= n; i += word_size)
+		{
+			r += std::popcount(load_word(data.data() + i, word_size));
+		}
+
+		for (; i < n; i++)
+		{
+			r += std::popcount(data[i]);
+		}
+
+		return r;
+	}
+
+	/**
+	 * @brief number of trailing zero bits, this is the same for x and -x
+	 *
+	 * @return size_t 0 for 0
+	 */
+	size_t dint::countr_zero() const
+	{
+		for (size_t i = 0; i < size(); i++)
+		{
+			if (data[i] != 0)
+			{
+				return i * bits_per_word + std::countr_zero(data[i]);
+			}
+		}
+
+		return 0;
+	}
+
+	/**
+	 * @brief number of bits in which the absolute values of a and b differ
+	 *
+	 * @param a
+	 * @param b
+	 * @return size_t
+	 */
+	size_t hamming_distance(const dint &a, const dint &b)
+	{
+		const dint &big   = a.size() >= b.size() ? a : b;
+		const dint &small = a.size() >= b.size() ? b : a;
+
+		size_t m = small.size();
+		size_t n = big.size();
+		size_t i = 0;
+		size_t r = 0;
+
+		const base *pb = big.data.data();
+		const base *ps = small.data.data();
+
+		for (; i + dint::word_size <= m; i += dint::word_size)
+		{
+			r += std::popcount(dint::load_word(pb + i, dint::word_size) ^ dint::load_word(ps + i, dint::word_size));
+		}
+
+		for (; i < m; i++)
+		{
+			r += std::popcount(static_cast<base>(pb[i] ^ ps[i]));
+		}
+
+		for (; i + dint::word_size <= n; i += dint::word_size)
+		{
+			r += std::popcount(dint::load_word(pb + i, dint::word_size));
+		}
+
+		for (; i < n; i++)
+		{
+			r += std::popcount(pb[i]);
+		}
+
+		return r;
+	}
+} // namespace bigint
@@ -0,0 +1,547 @@
+#include "dint.h"
+
+#include <unistd.h>
+
+#include <cerrno>
+
+namespace bigint
+{
+	// The largest power of 10 in a machine word, and its number of digits
+	static constexpr unsigned long long chunk = 10000000000000000000ULL;
+	static constexpr size_t chunk_digits	  = 19;
+
+	// Characters are read from a source and given to a sink this many at a time
+	static constexpr size_t buffer_size = 1 << 16;
+
+	// Decimal input is converted in blocks of 19 2^block_level digits
+	static constexpr size_t block_level = 10;
+
+	/**
+	 * @brief Collects characters and gives them to a sink buffer_size at a time.
+	 */
+	class output_buffer
+	{
+	  public:
+		explicit output_buffer(const digit_sink &s) : sink{s}
+		{
+			buffer.reserve(buffer_size);
+		}
+
+		void append(const char *p, size_t n)
+		{
+			while (n > 0)
+			{
+				const size_t k = min(n, buffer_size - buffer.size());
+
+				buffer.append(p, k);
+				p += k;
+				n -= k;
+
+				if (buffer.size() == buffer_size)
+				{
+					flush();
+				}
+			}
+		}
+
+		void append(const string &s)
+		{
+			append(s.data(), s.size());
+		}
+
+		void flush()
+		{
+			if (!buffer.empty())
+			{
+				sink(buffer.data(), buffer.size());
+				buffer.clear();
+			}
+		}
+
+	  private:
+		const digit_sink &sink;
+		string buffer;
+	};
+
+	/**
+	 * @brief Hands out the characters of a source one at a time, reading buffer_size of them at a time.
+	 */
+	class input_buffer
+	{
+	  public:
+		explicit input_buffer(const digit_source &s) : source{s}, buffer(buffer_size, 0) {}
+
+		// The next character, or -1 at the end of the input
+		int get()
+		{
+			if (position == end)
+			{
+				end		 = source(buffer.data(), buffer.size());
+				position = 0;
+
+				if (end == 0)
+				{
+					return -1;
+				}
+			}
+
+			return static_cast<unsigned char>(buffer[position++]);
+		}
+
+	  private:
+		const digit_source &source;
+		string buffer;
+
+		size_t position{0};
+		size_t end{0};
+	};
+
+	static bool is_space(int c)
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	/**
+	 * @brief skips the white space in front of a number and reads its sign
+	 *
+	 * @param in
+	 * @param c set to the first character after the sign
+	 * @return true for a -
+	 */
+	static bool read_sign(input_buffer &in, int &c)
+	{
+		do
+		{
+			c = in.get();
+		} while (is_space(c));
+
+		if (c == '-')
+		{
+			c = in.get();
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief appends the digits of x, split by the powers from the top down.
+	 * Both halves of a split have about the same size, so the divisions are balanced.
+	 *
+	 * @param x
+	 * @param powers powers[k] = 10^(19 2^k)
+	 * @param level x < powers[level]
+	 * @param pad write exactly 19 2^level digits, with leading zeros
+	 * @param out
+	 */
+	static void write_digits(const dint &x, const vector<dint> &powers, size_t level, bool pad, output_buffer &out)
+	{
+		if (level == 0)
+		{
+			const string s = std::to_string(static_cast<unsigned long long>(x));
+
+			if (pad)
+			{
+				out.append(string(chunk_digits - s.size(), '0'));
+			}
+
+			out.append(s);
+			return;
+		}
+
+		dint q, r;
+		divmod(x, powers[level - 1], q, r);
+
+		if (!pad && q.bit_length() == 0)
+		{
+			write_digits(r, powers, level - 1, false, out);
+			return;
+		}
+
+		write_digits(q, powers, level - 1, pad, out);
+		write_digits(r, powers, level - 1, true, out);
+	}
+
+	/**
+	 * @brief the number written by the 19 2^level decimal digits at p, split in halves down to a machine word
+	 *
+	 * @param p
+	 * @param level
+	 * @param powers powers[k] = 10^(19 2^k) for k < level
+	 */
+	static dint read_digits(const char *p, size_t level, const vector<dint> &powers)
+	{
+		if (level == 0)
+		{
+			unsigned long long r = 0;
+
+			for (size_t i = 0; i < chunk_digits; i++)
+			{
+				r = r * 10 + static_cast<unsigned long long>(p[i] - '0');
+			}
+
+			return dint{r};
+		}
+
+		const size_t half = chunk_digits << (level - 1);
+
+		return read_digits(p, level - 1, powers) * powers[level - 1] + read_digits(p + half, level - 1, powers);
+	}
+
+	/**
+	 * @brief the decimal representation of a, by divide and conquer over the powers 10^(19 2^k)
+	 *
+	 * @param a
+	 * @return string the digits, with a - in front for negative numbers
+	 */
+	string to_string(const dint &a)
+	{
+		string r;
+		write_decimal(a, [&r](const char *p, size_t n) { r.append(p, n); });
+
+		return r;
+	}
+
+	/**
+	 * @brief reads a number written in hexadecimal digits, with a - in front for negative numbers.
+	 * White space before and between the digits is skipped, so line broken digit files can be read. Besides the
+	 * result only a buffer of the input is held.
+	 *
+	 * @throw domain_error if there are no digits or something else than a digit
+	 */
+	dint read_hex(const digit_source &source)
+	{
+		constexpr size_t per_word = bits_per_word / 4;
+
+		input_buffer in{source};
+
+		int c;
+		const bool negative = read_sign(in, c);
+
+		// The words from the most significant one down
+		container words;
+
+		base w		 = 0;
+		size_t k	 = 0;
+		bool digits = false;
+
+		for (; c >= 0; c = in.get())
+		{
+			if (is_space(c))
+			{
+				continue;
+			}
+
+			base v;
+
+			if (c >= '0' && c <= '9')
+			{
+				v = static_cast<base>(c - '0');
+			}
+			else if (c >= 'a' && c <= 'f')
+			{
+				v = static_cast<base>(c - 'a' + 10);
+			}
+			else if (c >= 'A' && c <= 'F')
+			{
+				v = static_cast<base>(c - 'A' + 10);
+			}
+			else
+			{
+				throw domain_error("invalid hexadecimal digit");
+			}
+
+			digits = true;
+			w	   = static_cast<base>((w << 4) | v);
+
+			if (++k == per_word)
+			{
+				words.push_back(w);
+				w = 0;
+				k = 0;
+			}
+		}
+
+		if (!digits)
+		{
+			throw domain_error("no digits to read");
+		}
+
+		// The last digits fill the top of a word, the whole number is shifted down to them at the end
+		if (k > 0)
+		{
+			words.push_back(static_cast<base>(w << (4 * (per_word - k))));
+		}
+
+		reverse(words.begin(), words.end());
+
+		if (k > 0)
+		{
+			const unsigned int shift = static_cast<unsigned int>(4 * (per_word - k));
+
+			for (size_t i = 0; i < words.size(); i++)
+			{
+				const base above = i + 1 < words.size() ? words[i + 1] : 0;
+				words[i]		 = static_cast<base>((words[i] >> shift) | (above << (bits_per_word - shift)));
+			}
+		}
+
+		dint r{move(words)};
+
+		return negative && r.bit_length() != 0 ? -r : r;
+	}
+
+	/**
+	 * @brief reads a number written in decimal digits, with a - in front for negative numbers.
+	 * The digits are converted a block at a time by divide and conquer, and blocks of the same length are joined as
+	 * soon as there are two of them, so the joins are balanced products as well. Besides the result there are at most
+	 * one pending block per length and the powers of 10 to join them, together about the size of the result.
+	 * White space before and between the digits is skipped.
+	 *
+	 * @throw domain_error if there are no digits or something else than a digit
+	 */
+	dint read_decimal(const digit_source &source)
+	{
+		constexpr size_t block_digits = chunk_digits << block_level;
+
+		input_buffer in{source};
+
+		int c;
+		const bool negative = read_sign(in, c);
+
+		vector<dint> powers{dint{chunk}};
+
+		while (powers.size() < block_level)
+		{
+			powers.push_back(powers.back() * powers.back());
+		}
+
+		// The pending blocks, the most significant one first, with blocks[i] 19 2^levels[i] digits long
+		vector<dint> blocks;
+		vector<size_t> levels;
+
+		string digits;
+		digits.reserve(block_digits);
+
+		bool any = false;
+
+		for (; c >= 0; c = in.get())
+		{
+			if (is_space(c))
+			{
+				continue;
+			}
+
+			if (c < '0' || c > '9')
+			{
+				throw domain_error("invalid decimal digit");
+			}
+
+			any = true;
+			digits.push_back(static_cast<char>(c));
+
+			if (digits.size() < block_digits)
+			{
+				continue;
+			}
+
+			dint x		 = read_digits(digits.data(), block_level, powers);
+			size_t level = block_level;
+
+			digits.clear();
+
+			while (!levels.empty() && levels.back() == level)
+			{
+				if (powers.size() == level)
+				{
+					powers.push_back(powers.back() * powers.back());
+				}
+
+				x = blocks.back() * powers[level] + x;
+				level++;
+
+				blocks.pop_back();
+				levels.pop_back();
+			}
+
+			blocks.push_back(move(x));
+			levels.push_back(level);
+		}
+
+		if (!any)
+		{
+			throw domain_error("no digits to read");
+		}
+
+		// The last block, padded with leading zeros to the length of a whole one
+		const size_t rest = digits.size();
+
+		dint r;
+
+		if (rest > 0)
+		{
+			digits.insert(0, block_digits - rest, '0');
+			r = read_digits(digits.data(), block_level, powers);
+		}
+
+		// 10^(the digits of r), without the padding
+		dint scale = pow(dint{10ULL}, rest);
+
+		while (!blocks.empty())
+		{
+			r = blocks.back() * scale + r;
+
+			if (blocks.size() > 1)
+			{
+				scale *= powers[levels.back()];
+			}
+
+			blocks.pop_back();
+			levels.pop_back();
+		}
+
+		return negative && r.bit_length() != 0 ? -r : r;
+	}
+
+	/**
+	 * @brief writes a in hexadecimal digits without leading zeros, with a - in front for negative numbers, to the sink
+	 * buffer_size characters at a time
+	 */
+	void write_hex(const dint &a, const digit_sink &sink)
+	{
+		constexpr size_t per_word = bits_per_word / 4;
+		constexpr char hex[]	  = "0123456789abcdef";
+
+		output_buffer out{sink};
+
+		if (a.negative)
+		{
+			out.append("-", 1);
+		}
+
+		char word[per_word];
+
+		for (size_t i = a.data.size(); i-- > 0;)
+		{
+			base w = a.data[i];
+
+			for (size_t j = per_word; j-- > 0; w = static_cast<base>(w >> 4))
+			{
+				word[j] = hex[w & 0xf];
+			}
+
+			// The top word without its leading zeros, but at least one digit
+			size_t skip = 0;
+
+			if (i + 1 == a.data.size())
+			{
+				while (skip + 1 < per_word && word[skip] == '0')
+				{
+					skip++;
+				}
+			}
+
+			out.append(word + skip, per_word - skip);
+		}
+
+		out.flush();
+	}
+
+	/**
+	 * @brief writes the decimal representation of a, as to_string, to the sink buffer_size characters at a time.
+	 * Only the halves of the splits are held besides a, not the digits.
+	 */
+	void write_decimal(const dint &a, const digit_sink &sink)
+	{
+		dint negated;
+		const dint &x = a.neg() ? (negated = -a) : a;
+
+		vector<dint> powers{dint{chunk}};
+
+		while (powers.back().bit_length() <= x.bit_length())
+		{
+			powers.push_back(powers.back() * powers.back());
+		}
+
+		output_buffer out{sink};
+
+		if (a.neg())
+		{
+			out.append("-", 1);
+		}
+
+		write_digits(x, powers, powers.size() - 1, false, out);
+		out.flush();
+	}
+
+	digit_source istream_source(istream &in)
+	{
+		return [&in](char *p, size_t n)
+		{
+			in.read(p, static_cast<streamsize>(n));
+
+			if (in.bad())
+			{
+				throw runtime_error("cannot read the input stream");
+			}
+
+			return static_cast<size_t>(in.gcount());
+		};
+	}
+
+	digit_source fd_source(int fd)
+	{
+		return [fd](char *p, size_t n)
+		{
+			while (true)
+			{
+				const ssize_t r = read(fd, p, n);
+
+				if (r >= 0)
+				{
+					return static_cast<size_t>(r);
+				}
+
+				if (errno != EINTR)
+				{
+					throw runtime_error("cannot read from file descriptor " + std::to_string(fd));
+				}
+			}
+		};
+	}
+
+	digit_sink ostream_sink(ostream &out)
+	{
+		return [&out](const char *p, size_t n)
+		{
+			if (!out.write(p, static_cast<streamsize>(n)))
+			{
+				throw runtime_error("cannot write the output stream");
+			}
+		};
+	}
+
+	digit_sink fd_sink(int fd)
+	{
+		return [fd](const char *p, size_t n)
+		{
+			while (n > 0)
+			{
+				const ssize_t r = write(fd, p, n);
+
+				if (r < 0 && errno == EINTR)
+				{
+					continue;
+				}
+
+				if (r < 0)
+				{
+					throw runtime_error("cannot write to file descriptor " + std::to_string(fd));
+				}
+
+				p += r;
+				n -= static_cast<size_t>(r);
+			}
+		};
+	}
+} // namespace bigint
@@ -1,5 +1,9 @@
 #include "dint.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace bigint
 {
 	const dint &Nil{container{{}}};
@@ -17,10 +21,10 @@ namespace bigint
 		remove_leading_zeros();
 	}
 
-	dint::dint(long long arg) : data{}
+	dint::dint(long long arg)
+		: dint(arg < 0 ? 0ULL - static_cast<unsigned long long>(arg) : static_cast<unsigned long long>(arg))
 	{
 		negative = (arg < 0);
-		dint(static_cast<unsigned long long>(arg));
 	}
 
 	dint::dint(const container &arg) : data{arg}
@@ -28,7 +32,7 @@ namespace bigint
 		remove_leading_zeros();
 	}
 
-	dint::dint(container &&arg) : data{arg}
+	dint::dint(container &&arg) : data{move(arg)}
 	{
 		remove_leading_zeros();
 	}
@@ -75,113 +79,140 @@ namespace bigint
 		return negative;
 	}
 
-	bool dint::abslst(const dint &a, const dint &b)
+	/**
+	 * @brief the lowest 64 bits of the absolute value
+	 */
+	dint::operator unsigned long long() const
 	{
-		if (a.size() < b.size())
-		{
-			return true;
-		}
-		if (a.size() > b.size())
+		unsigned long long r = 0;
+
+		size_t words = min(size(), sizeof(unsigned long long) / sizeof(base));
+
+		for (size_t i = words; i-- > 0;)
 		{
-			return false;
+			r = (r << bits_per_word) | data[i];
 		}
 
-		auto pa = a.data.crbegin();
-		auto pb = b.data.crbegin();
+		return r;
+	}
 
-		for (; pa != a.data.crend(); pa++, pb++)
+	/**
+	 * @brief three way comparison of two word arrays of the same length.
+	 * The words are compared from the most significant end, sixteen at a time with SSE2,
+	 * and the first word that differs decides.
+	 *
+	 * @param pa
+	 * @param pb
+	 * @param i the number of words
+	 * @return int < 0, 0 or > 0 when the number at pa is less than, equal to or greater than the one at pb
+	 */
+	int dint::compare_words(const base *pa, const base *pb, size_t i)
+	{
+#if defined(__SSE2__)
+		if constexpr (sizeof(base) == 1)
 		{
-			if (*pa < *pb)
+			for (; i >= 16; i -= 16)
 			{
-				return true;
+				__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pa + i - 16));
+				__m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pb + i - 16));
+
+				// A bit for every word that differs
+				unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) ^ 0xFFFFu;
+
+				if (mask != 0)
+				{
+					size_t j = i - 16 + static_cast<size_t>(bit_width(mask)) - 1;
+					return pa[j] < pb[j] ? -1 : 1;
+				}
 			}
-			if (*pa > *pb)
+		}
+#endif
+
+		// Loaded as numbers, machine words compare like the words they hold
+		for (; i > 0; i -= min(i, word_size))
+		{
+			size_t n = min(i, word_size);
+
+			uint64_t x = load_word(pa + i - n, n);
+			uint64_t y = load_word(pb + i - n, n);
+
+			if (x != y)
 			{
-				return false;
+				return x < y ? -1 : 1;
 			}
 		}
 
-		return false;
+		return 0;
 	}
 
-	bool dint::absgrt(const dint &a, const dint &b)
+	/**
+	 * @brief three way comparison of the absolute values
+	 *
+	 * @param a
+	 * @param b
+	 * @return int < 0, 0 or > 0 when |a| is less than, equal to or greater than |b|
+	 */
+	int dint::compare_abs(const dint &a, const dint &b)
 	{
-		if (a.size() > b.size())
-		{
-			return true;
-		}
-		if (a.size() < b.size())
+		if (a.size() != b.size())
 		{
-			return false;
+			return a.size() < b.size() ? -1 : 1;
 		}
 
-		auto pa = a.data.crbegin();
-		auto pb = b.data.crbegin();
+		return compare_words(a.data.data(), b.data.data(), a.size());
+	}
+
+	bool dint::abslst(const dint &a, const dint &b)
+	{
+		return compare_abs(a, b) < 0;
+	}
 
-		for (; pa != a.data.crend(); pa++, pb++)
+	bool dint::absgrt(const dint &a, const dint &b)
+	{
+		return compare_abs(a, b) > 0;
+	}
+
+	/**
+	 * @brief three way comparison
+	 *
+	 * @param a
+	 * @param b
+	 * @return int < 0, 0 or > 0 when a is less than, equal to or greater than b
+	 */
+	int compare(const dint &a, const dint &b)
+	{
+		// Zero is not negative, whatever its sign says
+		bool an = a.negative && !(a.size() == 1 && a.data[0] == 0);
+		bool bn = b.negative && !(b.size() == 1 && b.data[0] == 0);
+
+		if (an != bn)
 		{
-			if (*pa > *pb)
-			{
-				return true;
-			}
-			if (*pa < *pb)
-			{
-				return false;
-			}
+			return an ? -1 : 1;
 		}
 
-		return false;
+		int c = dint::compare_abs(a, b);
+
+		return an ? -c : c;
+	}
+
+	strong_ordering operator<=>(const dint &a, const dint &b)
+	{
+		return compare(a, b) <=> 0;
 	}
 
 	bool operator>(const dint &a, const dint &b)
 	{
-		if (a.neg() && b.neg())
-		{
-			return dint::abslst(a, b);
-		}
-		if (a.neg())
-		{
-			return false;
-		}
-		if (b.neg())
-		{
-			return true;
-		}
-		return dint::absgrt(a, b);
+		return compare(a, b) > 0;
 	}
 
 	bool operator<(const dint &a, const dint &b)
 	{
-		if (a.neg() && b.neg())
-		{
-			return dint::absgrt(a, b);
-		}
-		if (a.neg())
-		{
-			return true;
-		}
-		if (b.neg())
-		{
-			return false;
-		}
-		return dint::abslst(a, b);
+		return compare(a, b) < 0;
 	}
 
 	bool operator==(const dint &a, const dint &b)
 	{
-		if (a.size() != b.size())
-		{
-			return false;
-		}
-
-		for (int i = a.size() - 1; i >= 0; i--)
-		{
-			if (a.data[i] != b.data[i])
-			{
-				return false;
-			}
-		}
-		return true;
+		return compare(a, b) == 0;
 	}
 
 	dint dint::operator<<(unsigned int n) const
@@ -197,13 +228,20 @@ namespace bigint
 	{
 		dint res{*this};
 
-		res.operator<<=(n);
+		res.operator>>=(n);
 
 		return res;
 	}
 
 	dint &dint::operator<<=(unsigned int n)
 	{
+		BIGINT_STAT(counters.count(stats::shift, size());)
+
+		if (size() == 1 && data[0] == 0)
+		{
+			return *this;
+		}
+
 		unsigned int m = n % bits_per_word;
 
 		base t = 0;
@@ -228,6 +266,8 @@ namespace bigint
 
 	dint &dint::operator>>=(unsigned int n)
 	{
+		BIGINT_STAT(counters.count(stats::shift, size());)
+
 		unsigned int m = n % bits_per_word;
 
 		base t = 0;
@@ -240,10 +280,7 @@ namespace bigint
 			t = (x & (numeric_limits<base>::max() >> (bits_per_word - m))) << (bits_per_word - m);
 		}
 
-		if (data.back() == 0)
-		{
-			data.pop_back();
-		}
+		remove_leading_zeros();
 
 		shiftwordsright(n / bits_per_word);
 
@@ -270,6 +307,39 @@ namespace bigint
 		data = t;
 	}
 
+	/**
+	 * @brief the value of a number that fits in a machine word
+	 *
+	 * @param a
+	 * @pre{a.size() <= word_size}
+	 */
+	uint64_t dint::get_word(const container &a)
+	{
+		return load_word(a.data(), a.size());
+	}
+
+	/**
+	 * @brief sets the absolute value to hi * 2^64 + lo, the sign is kept
+	 *
+	 * @param lo
+	 * @param hi
+	 * @post{data is normalized}
+	 */
+	void dint::set_word(uint64_t lo, uint64_t hi)
+	{
+		const size_t bytes = hi != 0 ? word_size + (bit_width(hi) + bits_per_word - 1) / bits_per_word
+									 : max<size_t>((bit_width(lo) + bits_per_word - 1) / bits_per_word, 1);
+
+		data.resize(bytes);
+
+		store_word(data.data(), lo, min(bytes, word_size));
+
+		if (bytes > word_size)
+		{
+			store_word(data.data() + word_size, hi, bytes - word_size);
+		}
+	}
+
 	void dint::remove_leading_zeros()
 	{
 
@@ -292,14 +362,82 @@ namespace bigint
 		}
 	}
 
-	void dint::random(int size, std::uniform_int_distribution<base> distr, std::mt19937 gen)
+	/**
+	 * @brief fills the dint with size random words.
+	 * If distr covers every word value the words are cut from the full 32 bit outputs of gen, which is unbiased
+	 * and needs a quarter of the calls.
+	 *
+	 * @param size the number of words
+	 * @param distr distribution of a single word
+	 * @param gen the generator, is advanced
+	 * @post{size() <= size}
+	 */
+	void dint::random(int size, std::uniform_int_distribution<base> &distr, std::mt19937 &gen)
 	{
-		data.resize(size);
+		data.resize(max(size, 1));
+		negative = false;
 
-		for (auto &i : data)
+		if (distr.min() == 0 && distr.max() == numeric_limits<base>::max())
 		{
-			i = distr(gen);
+			constexpr size_t per_output = sizeof(std::mt19937::result_type) / sizeof(base);
+
+			for (size_t i = 0; i < data.size(); i += per_output)
+			{
+				std::mt19937::result_type x = gen();
+
+				for (size_t j = i; j < min(data.size(), i + per_output); j++, x >>= bits_per_word)
+				{
+					data[j] = static_cast<base>(x);
+				}
+			}
+		}
+		else
+		{
+			for (auto &i : data)
+			{
+				i = distr(gen);
+			}
+		}
+
+		remove_leading_zeros();
+	}
+
+	/**
+	 * @brief the absolute value in n 64 bit words, truncated or padded with zeros
+	 */
+	vector<uint64_t> dint::to_words(const dint &a, size_t n)
+	{
+		constexpr size_t per_word = sizeof(uint64_t) / sizeof(base);
+
+		vector<uint64_t> r(n, 0);
+
+		for (size_t i = 0; i < min(a.size(), n * per_word); i++)
+		{
+			r[i / per_word] |= static_cast<uint64_t>(a.data[i]) << ((i % per_word) * bits_per_word);
+		}
+
+		return r;
+	}
+
+	/**
+	 * @brief the non-negative dint with the given 64 bit words
+	 */
+	dint dint::from_words(const vector<uint64_t> &w)
+	{
+		constexpr size_t per_word = sizeof(uint64_t) / sizeof(base);
+
+		container d(w.size() * per_word);
+
+		for (size_t i = 0; i < d.size(); i++)
+		{
+			d[i] = static_cast<base>(w[i / per_word] >> ((i % per_word) * bits_per_word));
 		}
+
+		dint r;
+		r.data = move(d);
+		r.remove_leading_zeros();
+
+		return r;
 	}
 
 	/**
@@ -0,0 +1,506 @@
+#include "dfloat.h"
+
+#include <cmath>
+
+namespace bigint
+{
+	static dint magnitude(const dint &x)
+	{
+		return x.neg() ? -x : x;
+	}
+
+	/**
+	 * @param x
+	 * @param precision the number of bits of the mantissa
+	 */
+	dfloat::dfloat(const dint &x, size_t precision) : dfloat{rounded(x, 0, precision)}
+	{
+	}
+
+	/**
+	 * @param x
+	 * @param precision the number of bits of the mantissa
+	 * @pre{x is finite}
+	 */
+	dfloat::dfloat(double x, size_t precision)
+	{
+		if (!std::isfinite(x))
+		{
+			throw domain_error("not a finite number");
+		}
+
+		int exp;
+		const double f = std::frexp(std::fabs(x), &exp);
+
+		// All 53 bits of the double are in the integer part of f 2^53
+		dint mant{static_cast<unsigned long long>(std::ldexp(f, 53))};
+
+		*this = rounded(x < 0 ? -mant : mant, exp - 53LL, precision);
+	}
+
+	/**
+	 * @brief x 2^e rounded to the nearest number with a mantissa of prec bits, ties to even
+	 *
+	 * @param x
+	 * @param e
+	 * @param prec
+	 * @param sticky the real value is a bit bigger than |x| 2^e, but less than 2^e bigger
+	 * @return dfloat
+	 * @pre{when sticky, x has more than prec bits}
+	 */
+	dfloat dfloat::rounded(dint x, long long e, size_t prec, bool sticky)
+	{
+		if (prec == 0)
+		{
+			throw domain_error("a precision of 0 bits");
+		}
+
+		dfloat r;
+		r.prec = prec;
+
+		const bool negative = x.neg();
+		if (negative)
+		{
+			x = -x;
+		}
+
+		const size_t bits = x.bit_length();
+
+		if (bits == 0)
+		{
+			return r;
+		}
+
+		if (bits <= prec)
+		{
+			x <<= static_cast<unsigned int>(prec - bits);
+			e -= static_cast<long long>(prec - bits);
+		}
+		else
+		{
+			const size_t s = bits - prec;
+
+			// The first bit that is cut off, and whether anything below it is set
+			const bool half = x.test_bit(s - 1);
+			const bool rest = sticky || x.countr_zero() < s - 1;
+
+			x >>= static_cast<unsigned int>(s);
+			e += static_cast<long long>(s);
+
+			if (half && (rest || x.test_bit(0)))
+			{
+				++x;
+
+				// Rounded up to a power of two
+				if (x.bit_length() > prec)
+				{
+					x >>= 1;
+					e++;
+				}
+			}
+		}
+
+		r.m = negative ? -x : x;
+		r.e = e;
+
+		return r;
+	}
+
+	size_t dfloat::precision() const
+	{
+		return prec;
+	}
+
+	/**
+	 * @brief rounds the number to the new precision
+	 */
+	void dfloat::set_precision(size_t precision)
+	{
+		*this = rounded(m, e, precision);
+	}
+
+	const dint &dfloat::mantissa() const
+	{
+		return m;
+	}
+
+	long long dfloat::exponent() const
+	{
+		return e;
+	}
+
+	bool dfloat::neg() const
+	{
+		return m.neg() && !is_zero();
+	}
+
+	bool dfloat::is_zero() const
+	{
+		return m.bit_length() == 0;
+	}
+
+	/**
+	 * @brief the integer part, rounded towards zero
+	 */
+	dint dfloat::to_dint() const
+	{
+		dint x = magnitude(m);
+
+		if (e >= 0)
+		{
+			x <<= static_cast<unsigned int>(e);
+		}
+		else
+		{
+			x >>= static_cast<unsigned int>(-e);
+		}
+
+		return neg() && x.bit_length() != 0 ? -x : x;
+	}
+
+	/**
+	 * @brief the nearest double to the top 64 bits of the mantissa
+	 */
+	dfloat::operator double() const
+	{
+		const size_t bits = m.bit_length();
+		const size_t s	  = bits > 64 ? bits - 64 : 0;
+
+		const double x = std::ldexp(static_cast<double>(static_cast<unsigned long long>(magnitude(m) >> static_cast<unsigned int>(s))),
+									static_cast<int>(e + static_cast<long long>(s)));
+
+		return neg() ? -x : x;
+	}
+
+	/**
+	 * @brief the mantissa in hex followed by p and the exponent in decimal
+	 */
+	string dfloat::toHexString() const
+	{
+		return m.toHexString() + "p" + to_string(e);
+	}
+
+	dfloat dfloat::operator-() const
+	{
+		dfloat r{*this};
+
+		if (!is_zero())
+		{
+			r.m = -r.m;
+		}
+
+		return r;
+	}
+
+	/**
+	 * @brief a + b or a - b rounded to prec bits.
+	 * When all of the smaller number lies below the last bit that matters for the rounding it only counts as a sticky bit,
+	 * otherwise the numbers are aligned and added exactly.
+	 *
+	 * @param a
+	 * @param b
+	 * @param negate substract b instead of adding it
+	 * @param prec
+	 */
+	dfloat dfloat::add_signed(const dfloat &a, const dfloat &b, bool negate, size_t prec)
+	{
+		const dint mb = negate ? -b.m : b.m;
+
+		if (b.is_zero())
+		{
+			return rounded(a.m, a.e, prec);
+		}
+
+		if (a.is_zero())
+		{
+			return rounded(mb, b.e, prec);
+		}
+
+		// x reaches the highest bit
+		const long long ta = a.e + static_cast<long long>(a.m.bit_length());
+		const long long tb = b.e + static_cast<long long>(b.m.bit_length());
+
+		const bool swap = tb > ta;
+
+		const dint &mx	= swap ? mb : a.m;
+		const dint &my	= swap ? a.m : mb;
+		const long long ex = swap ? b.e : a.e;
+		const long long ey = swap ? a.e : b.e;
+		const long long ty = swap ? ta : tb;
+
+		// Enough bits below x that y fits under its last bit, with two to spare for the rounding
+		const long long k = max<long long>(2, static_cast<long long>(prec) + 2 - static_cast<long long>(mx.bit_length()));
+
+		if (ty <= ex - k)
+		{
+			dint x = magnitude(mx) << static_cast<unsigned int>(k);
+
+			// |y| is less than one unit of x, on the side of its sign
+			if (mx.neg() != my.neg())
+			{
+				--x;
+			}
+
+			return rounded(mx.neg() ? -x : x, ex - k, prec, true);
+		}
+
+		const long long emin = min(ex, ey);
+
+		return rounded((mx << static_cast<unsigned int>(ex - emin)) + (my << static_cast<unsigned int>(ey - emin)), emin, prec);
+	}
+
+	/**
+	 * @brief a + b rounded to prec bits
+	 */
+	dfloat add(const dfloat &a, const dfloat &b, size_t prec)
+	{
+		return dfloat::add_signed(a, b, false, prec);
+	}
+
+	/**
+	 * @brief a - b rounded to prec bits
+	 */
+	dfloat sub(const dfloat &a, const dfloat &b, size_t prec)
+	{
+		return dfloat::add_signed(a, b, true, prec);
+	}
+
+	/**
+	 * @brief a b rounded to prec bits.
+	 * Mantissas longer than prec and the guard bits are cut to that many words, and when both are cut only the high half
+	 * of their product is computed with mulhigh. The real product lies between two bounds from the cut operands,
+	 * when both round to the same number that is the result, otherwise the exact product is rounded.
+	 */
+	dfloat mul(const dfloat &a, const dfloat &b, size_t prec)
+	{
+		if (a.is_zero() || b.is_zero())
+		{
+			return dfloat::rounded(dint{}, 0, prec);
+		}
+
+		const bool negative = a.neg() != b.neg();
+
+		const dint x = magnitude(a.m);
+		const dint y = magnitude(b.m);
+
+		// Words to keep of each mantissa
+		const size_t n = (prec + dfloat::guard_bits + bits_per_word - 1) / bits_per_word;
+
+		const size_t sx = x.size() > n ? x.size() - n : 0;
+		const size_t sy = y.size() > n ? y.size() - n : 0;
+
+		if (sx != 0 || sy != 0)
+		{
+			const dint cx = x >> static_cast<unsigned int>(sx * bits_per_word);
+			const dint cy = y >> static_cast<unsigned int>(sy * bits_per_word);
+
+			long long e = a.e + b.e + static_cast<long long>((sx + sy) * bits_per_word);
+
+			dint low, high;
+
+			if (sx != 0 && sy != 0)
+			{
+				// mulhigh is below the high words of cx cy by less than n, and cutting both adds less than 3 more
+				low	 = mulhigh(cx, cy, n);
+				high = low + dint{static_cast<unsigned long long>(n + 4)};
+				e += static_cast<long long>(n * bits_per_word);
+			}
+			else
+			{
+				low	 = cx * cy;
+				high = (sx != 0 ? cx + dint{1ULL} : cx) * (sy != 0 ? cy + dint{1ULL} : cy);
+			}
+
+			dfloat r	   = dfloat::rounded(low, e, prec);
+			const dfloat t = dfloat::rounded(high, e, prec);
+
+			if (r.m == t.m && r.e == t.e)
+			{
+				return negative ? -r : r;
+			}
+		}
+
+		dint p = x * y;
+
+		return dfloat::rounded(negative ? -p : p, a.e + b.e, prec);
+	}
+
+	/**
+	 * @brief a / b rounded to prec bits.
+	 * The dividend is shifted so the quotient has two bits more than prec, the bits shifted out and the remainder
+	 * make the sticky bit. A divisor longer than prec and the guard bits is cut, the real quotient then lies between two
+	 * quotients by the cut divisor, when both round to the same number that is the result, otherwise the whole divisor is used.
+	 *
+	 * @pre{b != 0}
+	 */
+	dfloat div(const dfloat &a, const dfloat &b, size_t prec)
+	{
+		if (b.is_zero())
+		{
+			throw domain_error("division by zero");
+		}
+
+		if (a.is_zero())
+		{
+			return dfloat::rounded(dint{}, 0, prec);
+		}
+
+		const bool negative = a.neg() != b.neg();
+
+		const dint x = magnitude(a.m);
+		const dint y = magnitude(b.m);
+
+		// x 2^k with dropped set when bits of x were shifted out
+		auto scaled = [&x](long long k, bool &dropped)
+		{
+			dropped = k < 0 && x.countr_zero() < static_cast<size_t>(-k);
+			return k >= 0 ? x << static_cast<unsigned int>(k) : x >> static_cast<unsigned int>(-k);
+		};
+
+		const size_t keep = prec + dfloat::guard_bits;
+
+		if (y.bit_length() > keep)
+		{
+			const size_t t = y.bit_length() - keep;
+			const dint cy  = y >> static_cast<unsigned int>(t);
+
+			const long long k = static_cast<long long>(prec + 2 + cy.bit_length()) - static_cast<long long>(x.bit_length());
+
+			bool dropped;
+			const dint nx = scaled(k, dropped);
+
+			// The real quotient nx / cy lies in (nx / (cy + 1), (nx + 1) / cy)
+			const long long e = a.e - b.e - static_cast<long long>(t) - k;
+
+			dfloat r	   = dfloat::rounded(nx / (cy + dint{1ULL}), e, prec);
+			const dfloat s = dfloat::rounded((nx + dint{1ULL}) / cy + dint{1ULL}, e, prec);
+
+			if (r.m == s.m && r.e == s.e)
+			{
+				return negative ? -r : r;
+			}
+		}
+
+		const long long k = static_cast<long long>(prec + 2 + y.bit_length()) - static_cast<long long>(x.bit_length());
+
+		bool dropped;
+		dint q, rem;
+		divmod(scaled(k, dropped), y, q, rem);
+
+		return dfloat::rounded(negative ? -q : q, a.e - b.e - k, prec, dropped || rem.bit_length() != 0);
+	}
+
+	/**
+	 * @brief the square root of a rounded to prec bits, from the integer square root of the mantissa
+	 * shifted to 2 prec + 4 bits with an even exponent
+	 *
+	 * @pre{a >= 0}
+	 */
+	dfloat sqrt(const dfloat &a, size_t prec)
+	{
+		if (a.neg())
+		{
+			throw domain_error("square root of a negative number");
+		}
+
+		if (a.is_zero())
+		{
+			return dfloat::rounded(dint{}, 0, prec);
+		}
+
+		long long s = static_cast<long long>(2 * prec + 4) - static_cast<long long>(a.m.bit_length());
+
+		if ((a.e - s) % 2 != 0)
+		{
+			s++;
+		}
+
+		const bool dropped = s < 0 && a.m.countr_zero() < static_cast<size_t>(-s);
+		const dint x	   = s >= 0 ? a.m << static_cast<unsigned int>(s) : a.m >> static_cast<unsigned int>(-s);
+
+		dint root, rem;
+		sqrtrem(x, root, rem);
+
+		return dfloat::rounded(root, (a.e - s) / 2, prec, dropped || rem.bit_length() != 0);
+	}
+
+	/**
+	 * @brief a 2^k, exactly
+	 */
+	dfloat ldexp(const dfloat &a, long long k)
+	{
+		dfloat r{a};
+
+		if (!r.is_zero())
+		{
+			r.e += k;
+		}
+
+		return r;
+	}
+
+	dfloat operator+(const dfloat &a, const dfloat &b)
+	{
+		return add(a, b, max(a.prec, b.prec));
+	}
+
+	dfloat operator-(const dfloat &a, const dfloat &b)
+	{
+		return sub(a, b, max(a.prec, b.prec));
+	}
+
+	dfloat operator*(const dfloat &a, const dfloat &b)
+	{
+		return mul(a, b, max(a.prec, b.prec));
+	}
+
+	dfloat operator/(const dfloat &a, const dfloat &b)
+	{
+		return div(a, b, max(a.prec, b.prec));
+	}
+
+	/**
+	 * @brief exact three way comparison, the precisions do not matter
+	 *
+	 * @return int < 0, 0 or > 0 when a is less than, equal to or greater than b
+	 */
+	int compare(const dfloat &a, const dfloat &b)
+	{
+		const int sa = a.is_zero() ? 0 : (a.neg() ? -1 : 1);
+		const int sb = b.is_zero() ? 0 : (b.neg() ? -1 : 1);
+
+		if (sa != sb || sa == 0)
+		{
+			return sa < sb ? -1 : (sa > sb ? 1 : 0);
+		}
+
+		const long long ta = a.e + static_cast<long long>(a.m.bit_length());
+		const long long tb = b.e + static_cast<long long>(b.m.bit_length());
+
+		int r;
+
+		if (ta != tb)
+		{
+			r = ta < tb ? -1 : 1;
+		}
+		else
+		{
+			// The top bits line up, so the shifts are at most the difference in precision
+			const long long emin = min(a.e, b.e);
+
+			r = compare(magnitude(a.m) << static_cast<unsigned int>(a.e - emin), magnitude(b.m) << static_cast<unsigned int>(b.e - emin));
+		}
+
+		return sa > 0 ? r : -r;
+	}
+
+	bool operator==(const dfloat &a, const dfloat &b)
+	{
+		return compare(a, b) == 0;
+	}
+
+	strong_ordering operator<=>(const dfloat &a, const dfloat &b)
+	{
+		return compare(a, b) <=> 0;
+	}
+} // namespace bigint
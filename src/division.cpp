@@ -0,0 +1,541 @@
+#include "dint.h"
+#include "progress.h"
+
+namespace bigint
+{
+	/**
+	 * @brief divides the absolute value of a by the machine word d, seven words at a time
+	 *
+	 * @param a
+	 * @param d
+	 * @param q the quotient will go into this container, may be a
+	 * @return uint64_t the remainder
+	 * @pre{d != 0}
+	 * @pre{q.size() == a.size()}
+	 */
+	uint64_t dint::div_word(const container &a, uint64_t d, container &q)
+	{
+		// The remainder is below d, so with seven words appended it still fits in 128 bits
+		constexpr size_t group = word_size - 1;
+
+		unsigned __int128 r = 0;
+
+		size_t i = a.size();
+
+		for (size_t n = i % group; i > 0; i -= n, n = group)
+		{
+			r = (r << (n * bits_per_word)) | load_word(a.data() + i - n, n);
+
+			store_word(q.data() + i - n, static_cast<uint64_t>(r / d), n);
+			r %= d;
+		}
+
+		return static_cast<uint64_t>(r);
+	}
+
+	/**
+	 * @brief long division of the absolute values (Knuth, TAOCP vol 2, algorithm D)
+	 *
+	 * @param a
+	 * @param b
+	 * @param q the quotient
+	 * @param r the remainder
+	 * @pre{b.size() >= 2}
+	 * @pre{|a| >= |b|}
+	 * @pre{q and r do not overlap with a and b}
+	 */
+	void dint::divabs(const dint &a, const dint &b, dint &q, dint &r)
+	{
+		constexpr unsigned int radix = 1U << bits_per_word;
+
+		// Normalize so the most significant bit of the divisor is set, this keeps the quotient estimates within 2 of the real value
+		unsigned int s = countl_zero(b.data.back());
+
+		dint u{a};
+		dint v{b};
+
+		u.negative = false;
+		v.negative = false;
+
+		u <<= s;
+		v <<= s;
+
+		// One extra word so u[j + n] always exists
+		u.data.push_back(0);
+
+		const size_t n = v.size();
+		const size_t m = u.size() - n;
+
+		q.data.assign(m, base{0});
+		q.negative = false;
+
+		const unsigned int v1 = v.data[n - 1];
+		const unsigned int v2 = v.data[n - 2];
+
+		for (size_t j = m; j-- > 0;)
+		{
+			progress::checkpoint(n);
+
+			// Estimate the quotient word from the top two words of the remainder
+			unsigned int num  = (static_cast<unsigned int>(u.data[j + n]) << bits_per_word) | u.data[j + n - 1];
+			unsigned int qhat = num / v1;
+			unsigned int rhat = num % v1;
+
+			while (qhat >= radix || qhat * v2 > ((rhat << bits_per_word) | u.data[j + n - 2]))
+			{
+				qhat--;
+				rhat += v1;
+				if (rhat >= radix)
+				{
+					break;
+				}
+			}
+
+			// Multiply and substract qhat * v from u[j..j + n]
+			unsigned int c = 0;
+			unsigned int borrow = 0;
+
+			for (size_t i = 0; i < n; i++)
+			{
+				unsigned int p = qhat * v.data[i] + c;
+				c			   = p >> bits_per_word;
+
+				unsigned int t = u.data[i + j];
+				unsigned int d = (p & (radix - 1)) + borrow;
+
+				u.data[i + j] = static_cast<base>(t - d);
+				borrow		  = t < d ? 1 : 0;
+			}
+
+			unsigned int t = u.data[j + n];
+			unsigned int d = c + borrow;
+
+			u.data[j + n] = static_cast<base>(t - d);
+
+			if (t < d)
+			{
+				// The estimate was one too big, add v back
+				qhat--;
+
+				additer(u.data.cbegin() + j, u.data.cbegin() + j + n + 1, v.data.cbegin(), v.data.cend(), u.data.begin() + j,
+						u.data.begin() + j + n + 1, false);
+			}
+
+			q.data[j] = static_cast<base>(qhat);
+		}
+
+		q.remove_leading_zeros();
+
+		u.data.resize(n);
+		u.remove_leading_zeros();
+		u >>= s;
+
+		r = move(u);
+	}
+
+	/**
+	 * @brief divides a by b, the quotient is truncated towards zero
+	 *
+	 * @param a
+	 * @param b
+	 * @param q the quotient will go into this dint
+	 * @param r the remainder will go into this dint
+	 * @post{a == q * b + r}
+	 * @post{r == 0 or r has the sign of a}
+	 * @post{|r| < |b|}
+	 */
+	void divmod(const dint &a, const dint &b, dint &q, dint &r)
+	{
+		BIGINT_STAT(counters.count(stats::div, a.size());)
+
+		if (b.size() == 1 && b.data[0] == 0)
+		{
+			throw domain_error("division by zero");
+		}
+
+		bool qneg = a.negative != b.negative;
+		bool rneg = a.negative;
+
+		if (dint::abslst(a, b))
+		{
+			r = a;
+			q = dint{};
+		}
+		else if (a.size() <= dint::word_size)
+		{
+			uint64_t x = dint::get_word(a.data);
+			uint64_t y = dint::get_word(b.data);
+
+			q.set_word(x / y);
+			r.set_word(x % y);
+		}
+		else if (b.size() <= dint::word_size)
+		{
+			container t(a.size());
+			uint64_t x = dint::div_word(a.data, dint::get_word(b.data), t);
+
+			q = dint{move(t)};
+			r.set_word(x);
+		}
+		else
+		{
+			dint tq, tr;
+			dint::divabs(a, b, tq, tr);
+
+			q = move(tq);
+			r = move(tr);
+		}
+
+		q.negative = qneg && !(q.size() == 1 && q.data[0] == 0);
+		r.negative = rneg && !(r.size() == 1 && r.data[0] == 0);
+	}
+
+	dint operator/(const dint &a, const dint &b)
+	{
+		dint q, r;
+		divmod(a, b, q, r);
+		return q;
+	}
+
+	dint operator%(const dint &a, const dint &b)
+	{
+		dint q, r;
+		divmod(a, b, q, r);
+		return r;
+	}
+
+	void dint::operator/=(const dint &a)
+	{
+		dint r;
+		divmod(*this, a, *this, r);
+	}
+
+	void dint::operator%=(const dint &a)
+	{
+		dint q;
+		divmod(*this, a, q, *this);
+	}
+
+	/**
+	 * @brief remainder of the absolute value of a divided by a machine word
+	 *
+	 * @param a
+	 * @param m
+	 * @return unsigned long long |a| mod m
+	 * @pre{m != 0}
+	 */
+	unsigned long long mod_word(const dint &a, unsigned long long m)
+	{
+		// Seven words at a time, so the intermediate value fits in 128 bits
+		constexpr size_t group = 7;
+
+		unsigned __int128 r = 0;
+
+		size_t i = a.size();
+
+		for (; i >= group; i -= group)
+		{
+			unsigned long long x = 0;
+			for (size_t j = i; j > i - group; j--)
+			{
+				x = (x << bits_per_word) | a.data[j - 1];
+			}
+			r = ((r << (group * bits_per_word)) | x) % m;
+		}
+
+		for (; i > 0; i--)
+		{
+			r = ((r << bits_per_word) | a.data[i - 1]) % m;
+		}
+
+		return static_cast<unsigned long long>(r);
+	}
+
+	/**
+	 * @brief d^-1 mod 2^64 with Newton's iteration, d * d = 1 (mod 8) so every step doubles the 3 correct bits
+	 *
+	 * @pre{d is odd}
+	 */
+	static uint64_t inverse_word(uint64_t d)
+	{
+		uint64_t inv = d;
+		for (int i = 0; i < 5; i++)
+		{
+			inv *= 2 - d * inv;
+		}
+		return inv;
+	}
+
+	/**
+	 * @brief Hensel division of a by d from the least significant word up: q_i = a_i d^-1 mod 2^64 makes word i of
+	 * a - q_i d 2^(64 i) zero. Unlike the schoolbook division no quotient word is estimated or corrected.
+	 *
+	 * @param a the absolute value in words, on return (a - q d) / 2^(64 q.size()) is in the words from q.size() up
+	 * @param d
+	 * @param q the lowest q.size() words of the quotient, the whole quotient when d divides a
+	 * @param full substract from all words of a, otherwise only the words below q.size() are kept up to date
+	 * @return bool whether any of the substractions borrowed out of the top of a, then the remaining part is negative
+	 * @pre{d is odd}
+	 */
+	static bool hensel(vector<uint64_t> &a, const vector<uint64_t> &d, vector<uint64_t> &q, bool full)
+	{
+		const uint64_t inv = inverse_word(d[0]);
+
+		const size_t qn	   = q.size();
+		const size_t limit = full ? a.size() : qn;
+
+		// Every quotient word substracts more, so a borrow in any of them makes the remaining part negative
+		bool borrowed = false;
+
+		for (size_t i = 0; i < qn; i++)
+		{
+			const uint64_t qi = a[i] * inv;
+			q[i]			  = qi;
+
+			const size_t m = min(d.size(), limit - i);
+
+			uint64_t c = 0;
+
+			for (size_t j = 0; j < m; j++)
+			{
+				unsigned __int128 p = static_cast<unsigned __int128>(qi) * d[j] + c;
+
+				const uint64_t lo = static_cast<uint64_t>(p);
+				const uint64_t t  = a[i + j];
+
+				a[i + j] = t - lo;
+				c		 = static_cast<uint64_t>(p >> 64) + (t < lo);
+			}
+
+			for (size_t k = i + m; c != 0 && k < limit; k++)
+			{
+				const uint64_t t = a[k];
+
+				a[k] = t - c;
+				c	 = t < c;
+			}
+
+			borrowed = borrowed || c != 0;
+		}
+
+		return borrowed;
+	}
+
+	/**
+	 * @brief a / d when d is known to divide a, several times faster than divmod.
+	 * The powers of two are shifted out and the rest is a Hensel division on machine words that only computes
+	 * the words of the quotient, without looking at the remainder.
+	 *
+	 * @param a
+	 * @param d
+	 * @return dint
+	 * @pre{d divides a}
+	 */
+	dint divexact(const dint &a, const dint &d)
+	{
+		if (d.size() == 1 && d.data[0] == 0)
+		{
+			throw domain_error("division by zero");
+		}
+
+		if (d.size() <= dint::word_size)
+		{
+			dint q = divexact_by_small(a, dint::get_word(d.data));
+			q.negative = (a.negative != d.negative) && !(q.size() == 1 && q.data[0] == 0);
+			return q;
+		}
+
+		const unsigned int s = static_cast<unsigned int>(d.countr_zero());
+
+		dint u{a}, v{d};
+		u >>= s;
+		v >>= s;
+
+		if (u.size() < v.size())
+		{
+			return dint{};
+		}
+
+		const size_t un = (u.size() + dint::word_size - 1) / dint::word_size;
+		const size_t vn = (v.size() + dint::word_size - 1) / dint::word_size;
+
+		vector<uint64_t> x = dint::to_words(u, un);
+		vector<uint64_t> q(un - vn + 1);
+
+		hensel(x, dint::to_words(v, vn), q, false);
+
+		dint r	   = dint::from_words(q);
+		r.negative = (a.negative != d.negative) && !(r.size() == 1 && r.data[0] == 0);
+
+		return r;
+	}
+
+	/**
+	 * @brief a / d for a machine word d that is known to divide a, one multiplication per word and no division
+	 *
+	 * @param a
+	 * @param d
+	 * @return dint with the sign of a
+	 * @pre{d divides a}
+	 */
+	dint divexact_by_small(const dint &a, unsigned long long d)
+	{
+		if (d == 0)
+		{
+			throw domain_error("division by zero");
+		}
+
+		const unsigned int s = static_cast<unsigned int>(std::countr_zero(d));
+		d >>= s;
+
+		const uint64_t inv = inverse_word(d);
+
+		const base *pa = a.data.data();
+		const size_t n = a.size();
+
+		// Word i of a >> s, the bits shifted out are zero as d divides a
+		auto shifted = [pa, n, s](size_t i)
+		{
+			uint64_t w = dint::load_word(pa + i, min(dint::word_size, n - i)) >> s;
+
+			if (s != 0 && i + dint::word_size < n)
+			{
+				w |= dint::load_word(pa + i + dint::word_size, min(dint::word_size, n - i - dint::word_size)) << (64 - s);
+			}
+
+			return w;
+		};
+
+		dint q;
+		q.data.resize(n);
+
+		uint64_t c = 0;
+
+		for (size_t i = 0; i < n; i += dint::word_size)
+		{
+			const size_t k = min(dint::word_size, n - i);
+
+			// The borrow of the words below comes off before this word of the quotient is found
+			const uint64_t w  = shifted(i);
+			const uint64_t x  = w - c;
+			const uint64_t qi = x * inv;
+
+			dint::store_word(q.data.data() + i, qi, k);
+
+			c = static_cast<uint64_t>((static_cast<unsigned __int128>(qi) * d) >> 64) + (w < c);
+		}
+
+		q.remove_leading_zeros();
+		q.negative = a.negative && !(q.size() == 1 && q.data[0] == 0);
+
+		return q;
+	}
+
+	/**
+	 * @brief whether d divides a, without computing a quotient for a machine word d.
+	 * The Hensel division leaves a - q d = -c 2^(64 n) with c <= d, and d is odd so it divides a exactly when it divides c.
+	 *
+	 * @param a
+	 * @param d
+	 * @return bool true for d == 0 only when a == 0
+	 */
+	bool divisible_p(const dint &a, unsigned long long d)
+	{
+		const bool zero = a.size() == 1 && a.data[0] == 0;
+
+		if (d == 0 || zero)
+		{
+			return zero;
+		}
+
+		const size_t s = static_cast<size_t>(std::countr_zero(d));
+
+		if (a.countr_zero() < s)
+		{
+			return false;
+		}
+
+		d >>= s;
+
+		const uint64_t inv = inverse_word(d);
+
+		// The low s bits of a are zero, the odd part of d does not care about them
+		const base *pa = a.data.data();
+		const size_t n = a.size();
+
+		uint64_t c = 0;
+
+		for (size_t i = 0; i < n; i += dint::word_size)
+		{
+			const uint64_t w  = dint::load_word(pa + i, min(dint::word_size, n - i));
+			const uint64_t qi = (w - c) * inv;
+
+			c = static_cast<uint64_t>((static_cast<unsigned __int128>(qi) * d) >> 64) + (w < c);
+		}
+
+		return c == 0 || c == d;
+	}
+
+	/**
+	 * @brief whether d divides a, by a Hensel division that clears the low words of a and checks that nothing is left above them
+	 *
+	 * @param a
+	 * @param d
+	 * @return bool true for d == 0 only when a == 0
+	 */
+	bool divisible_p(const dint &a, const dint &d)
+	{
+		if (d.size() <= dint::word_size)
+		{
+			return divisible_p(a, dint::get_word(d.data));
+		}
+
+		const size_t s = d.countr_zero();
+
+		if (a.size() == 1 && a.data[0] == 0)
+		{
+			return true;
+		}
+
+		if (a.countr_zero() < s)
+		{
+			return false;
+		}
+
+		dint u{a}, v{d};
+		u >>= static_cast<unsigned int>(s);
+		v >>= static_cast<unsigned int>(s);
+
+		if (u.size() < v.size())
+		{
+			return false;
+		}
+
+		const size_t un = (u.size() + dint::word_size - 1) / dint::word_size;
+		const size_t vn = (v.size() + dint::word_size - 1) / dint::word_size;
+
+		vector<uint64_t> x = dint::to_words(u, un);
+		vector<uint64_t> q(un - vn + 1);
+
+		// Without a borrow q d <= a, and q is a / d whenever d divides a, so only a remaining 0 is a multiple of d
+		if (hensel(x, dint::to_words(v, vn), q, true))
+		{
+			return false;
+		}
+
+		return all_of(x.begin() + q.size(), x.end(), [](uint64_t w) { return w == 0; });
+	}
+
+	/**
+	 * @brief whether a and c are congruent modulo d
+	 *
+	 * @param a
+	 * @param c
+	 * @param d
+	 * @return bool for d == 0 whether a == c
+	 */
+	bool congruent_p(const dint &a, const dint &c, const dint &d)
+	{
+		return divisible_p(a - c, d);
+	}
+} // namespace bigint
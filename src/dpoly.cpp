@@ -0,0 +1,651 @@
+#include "dpoly.h"
+#include "parallel.h"
+
+namespace bigint
+{
+	// Below this many coefficients in the divisor or the quotient, division modulo a number is done coefficient by coefficient
+	static constexpr size_t newton_threshold = 32;
+
+	/**
+	 * @brief x mod m in [0, m)
+	 */
+	static dint reduce(const dint &x, const dint &m)
+	{
+		dint r = x % m;
+
+		if (r.neg())
+		{
+			r += m;
+		}
+
+		return r;
+	}
+
+	/**
+	 * @param coefficients from the constant term up
+	 */
+	dpoly::dpoly(vector<dint> coefficients) : c{move(coefficients)}
+	{
+		normalize();
+	}
+
+	void dpoly::normalize()
+	{
+		while (!c.empty() && c.back().bit_length() == 0)
+		{
+			c.pop_back();
+		}
+	}
+
+	long long dpoly::degree() const
+	{
+		return static_cast<long long>(c.size()) - 1;
+	}
+
+	bool dpoly::is_zero() const
+	{
+		return c.empty();
+	}
+
+	const dint &dpoly::operator[](size_t i) const
+	{
+		return i < c.size() ? c[i] : Nil;
+	}
+
+	const vector<dint> &dpoly::coefficients() const
+	{
+		return c;
+	}
+
+	/**
+	 * @brief the coefficients in slots of the given number of words, as the number sum a_i 2^(i bits)
+	 * The positive and the negative coefficients are copied into two numbers, of which the difference is taken.
+	 *
+	 * @param a
+	 * @param words
+	 * @pre{every coefficient fits in words}
+	 */
+	dint dpoly::pack(const vector<dint> &a, size_t words)
+	{
+		dint p, n;
+		p.data.assign(a.size() * words, 0);
+
+		bool negative = false;
+
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			if (a[i].negative && !negative)
+			{
+				n.data.assign(a.size() * words, 0);
+				negative = true;
+			}
+
+			dint &dest = a[i].negative ? n : p;
+			copy(a[i].data.begin(), a[i].data.end(), dest.data.begin() + i * words);
+		}
+
+		p.remove_leading_zeros();
+
+		if (!negative)
+		{
+			return p;
+		}
+
+		n.remove_leading_zeros();
+
+		return p - n;
+	}
+
+	/**
+	 * @brief the inverse of pack.
+	 * A slot of k bits holds a coefficient between -2^(k - 1) and 2^(k - 1), the slots from 2^(k - 1) up stand for
+	 * negative coefficients that borrowed 1 from the next slot.
+	 *
+	 * @param x
+	 * @param words
+	 * @param count the number of coefficients
+	 * @pre{every coefficient is smaller than 2^(k - 1) in absolute value}
+	 */
+	vector<dint> dpoly::unpack(const dint &x, size_t words, size_t count)
+	{
+		const size_t bits = words * bits_per_word;
+		const dint slot	  = dint{1ULL} << static_cast<unsigned int>(bits);
+
+		vector<dint> r(count);
+
+		bool borrow = false;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const size_t begin = min(i * words, x.data.size());
+			const size_t end   = min(begin + words, x.data.size());
+
+			dint v;
+			v.data.assign(x.data.begin() + begin, x.data.begin() + end);
+			v.remove_leading_zeros();
+
+			if (borrow)
+			{
+				++v;
+			}
+
+			borrow = v.bit_length() >= bits;
+
+			if (borrow)
+			{
+				v -= slot;
+			}
+
+			r[i] = x.negative ? -v : move(v);
+		}
+
+		return r;
+	}
+
+	/**
+	 * @brief a b by Kronecker substitution, with the coefficients reduced when a modulus is given.
+	 * The slots have room for the largest possible coefficient of the product and a sign,
+	 * so the product of the packed numbers holds every coefficient of the product in its own slot.
+	 *
+	 * @param a
+	 * @param b
+	 * @param m the modulus or nullptr
+	 */
+	dpoly dpoly::multiply(const dpoly &a, const dpoly &b, const dint *m)
+	{
+		if (a.is_zero() || b.is_zero())
+		{
+			return {};
+		}
+
+		size_t abits = 0, bbits = 0;
+
+		for (const dint &x : a.c)
+		{
+			abits = max(abits, x.bit_length());
+		}
+
+		for (const dint &x : b.c)
+		{
+			bbits = max(bbits, x.bit_length());
+		}
+
+		// A coefficient of the product is a sum of at most min(|a|, |b|) products
+		const size_t bits  = abits + bbits + bit_width(min(a.c.size(), b.c.size())) + 1;
+		const size_t words = (bits + bits_per_word - 1) / bits_per_word;
+
+		dint x = pack(a.c, words);
+
+		if (&a == &b)
+		{
+			mult(x, x, x);
+		}
+		else
+		{
+			mult(x, pack(b.c, words), x);
+		}
+
+		dpoly r;
+		r.c = unpack(x, words, a.c.size() + b.c.size() - 1);
+
+		if (m)
+		{
+			for (dint &y : r.c)
+			{
+				y = reduce(y, *m);
+			}
+		}
+
+		r.normalize();
+
+		return r;
+	}
+
+	/**
+	 * @brief a mod x^n
+	 */
+	dpoly dpoly::truncated(const dpoly &a, size_t n)
+	{
+		return vector<dint>(a.c.begin(), a.c.begin() + min(n, a.c.size()));
+	}
+
+	/**
+	 * @brief x^(n - 1) a(1 / x), the first n coefficients of a in reverse order
+	 */
+	dpoly dpoly::reversed(const dpoly &a, size_t n)
+	{
+		vector<dint> r(n);
+
+		for (size_t i = 0; i < n && i < a.c.size(); i++)
+		{
+			r[n - 1 - i] = a.c[i];
+		}
+
+		return r;
+	}
+
+	/**
+	 * @brief f^-1 mod x^n by Newton's iteration g = g (2 - f g), which doubles the number of correct coefficients.
+	 *
+	 * @param f
+	 * @param n
+	 * @param m the modulus or nullptr
+	 * @pre{f[0] is 1 or -1, or invertible modulo m}
+	 */
+	dpoly dpoly::inverse(const dpoly &f, size_t n, const dint *m)
+	{
+		const dpoly two{{dint{2ULL}}};
+
+		// 1 and -1 are their own inverse
+		dpoly g{{m ? invmod(f[0], *m) : f[0]}};
+
+		for (size_t k = 1; k < n;)
+		{
+			k = min(2 * k, n);
+
+			dpoly e = two - truncated(multiply(truncated(f, k), g, m), k);
+
+			if (m)
+			{
+				e = mod(e, *m);
+			}
+
+			g = truncated(multiply(g, e, m), k);
+		}
+
+		return g;
+	}
+
+	/**
+	 * @brief the quotient and remainder of a by b.
+	 * Small divisions eliminate the leading coefficient of the remainder one at a time. Larger ones modulo a number find
+	 * the quotient from the reversed polynomials, rev(q) = rev(a) rev(b)^-1 mod x^(|a| - |b| + 1), and the remainder
+	 * as a - q b. Over the integers the coefficients of rev(b)^-1 and of the quotient grow with their index, and
+	 * eliminating one at a time only multiplies them by the small coefficients of b, which is faster at every size.
+	 *
+	 * @param a
+	 * @param b
+	 * @param q
+	 * @param r
+	 * @param m the modulus or nullptr
+	 * @pre{the coefficients are reduced when there is a modulus}
+	 */
+	void dpoly::divide(const dpoly &a, const dpoly &b, dpoly &q, dpoly &r, const dint *m)
+	{
+		if (b.is_zero())
+		{
+			throw domain_error("division by zero");
+		}
+
+		const dint &lead = b.c.back();
+
+		if (!m && !(lead.size() == 1 && lead.data[0] == 1))
+		{
+			throw domain_error("the leading coefficient of the divisor is not 1 or -1");
+		}
+
+		if (a.c.size() < b.c.size())
+		{
+			q = {};
+			r = a;
+			return;
+		}
+
+		const size_t n = a.c.size(), k = b.c.size(), l = n - k + 1;
+
+		if (!m || k < newton_threshold || l < newton_threshold)
+		{
+			const dint inv = m ? invmod(lead, *m) : lead;
+
+			vector<dint> rem{a.c};
+			vector<dint> quo(l);
+
+			for (size_t i = n; i-- > k - 1;)
+			{
+				dint t = rem[i] * inv;
+
+				if (m)
+				{
+					t = reduce(t, *m);
+				}
+
+				if (t.bit_length() == 0)
+				{
+					continue;
+				}
+
+				for (size_t j = 0; j < k; j++)
+				{
+					dint &y = rem[i - k + 1 + j];
+					y -= t * b.c[j];
+
+					if (m)
+					{
+						y = reduce(y, *m);
+					}
+				}
+
+				quo[i - k + 1] = move(t);
+			}
+
+			rem.resize(k - 1);
+
+			q = move(quo);
+			r = move(rem);
+			return;
+		}
+
+		const dpoly inv = inverse(reversed(b, k), l, m);
+		dpoly quo		= reversed(truncated(multiply(truncated(reversed(a, n), l), inv, m), l), l);
+		dpoly rem		= truncated(a - multiply(quo, b, m), k - 1);
+
+		if (m)
+		{
+			rem = mod(rem, *m);
+		}
+
+		q = move(quo);
+		r = move(rem);
+	}
+
+	/**
+	 * @brief a(x_i) mod m for all points, by reducing a from the root of the product tree of the x - x_i down to its
+	 * leaves. The remainder modulo x - x_i is a(x_i), and a remainder of the parent has a lower degree than the product
+	 * of the children, so every level costs about as much as a few products of polynomials of the degree of a.
+	 * The nodes of a level are independent and are done in parallel.
+	 *
+	 * @param a
+	 * @param points
+	 * @param m
+	 * @param threads
+	 * @pre{the coefficients of a are reduced}
+	 */
+	vector<dint> dpoly::descend(const dpoly &a, span<const dint> points, const dint &m, size_t threads)
+	{
+		if (points.empty())
+		{
+			return {};
+		}
+
+		vector<vector<dpoly>> tree(1);
+
+		for (const dint &x : points)
+		{
+			tree[0].push_back(vector<dint>{reduce(-x, m), dint{1ULL}});
+		}
+
+		while (tree.back().size() > 1)
+		{
+			const vector<dpoly> &below = tree.back();
+			vector<dpoly> level((below.size() + 1) / 2);
+
+			parallel_for(level.size(), threads,
+						 [&](size_t i)
+						 {
+							 if (2 * i + 1 < below.size())
+							 {
+								 level[i] = multiply(below[2 * i], below[2 * i + 1], &m);
+							 }
+							 else
+							 {
+								 level[i] = below[2 * i];
+							 }
+						 });
+
+			tree.push_back(move(level));
+		}
+
+		vector<dpoly> r(1);
+		dpoly q;
+		divide(a, tree.back()[0], q, r[0], &m);
+
+		for (size_t k = tree.size() - 1; k-- > 0;)
+		{
+			const vector<dpoly> &level = tree[k];
+			vector<dpoly> next(level.size());
+
+			parallel_for(next.size(), threads,
+						 [&](size_t i)
+						 {
+							 dpoly quotient;
+							 divide(r[i / 2], level[i], quotient, next[i], &m);
+						 });
+
+			r = move(next);
+		}
+
+		vector<dint> values(r.size());
+
+		for (size_t i = 0; i < r.size(); i++)
+		{
+			values[i] = r[i][0];
+		}
+
+		return values;
+	}
+
+	/**
+	 * @brief a(x) by Horner's rule
+	 */
+	dint dpoly::evaluate(const dint &x) const
+	{
+		dint r;
+
+		for (size_t i = c.size(); i-- > 0;)
+		{
+			r *= x;
+			r += c[i];
+		}
+
+		return r;
+	}
+
+	/**
+	 * @brief a(x) mod m by Horner's rule
+	 *
+	 * @pre{modulus > 0}
+	 */
+	dint dpoly::evaluate(const dint &x, const dint &modulus) const
+	{
+		const dint y = reduce(x, modulus);
+
+		dint r;
+
+		for (size_t i = c.size(); i-- > 0;)
+		{
+			r = reduce(r * y + c[i], modulus);
+		}
+
+		return r;
+	}
+
+	/**
+	 * @brief a(x_i) for every point x_i, by Horner's rule at every point in parallel.
+	 * Over the integers a(x_i) has about deg a times as many bits as x_i, and so do the remainders in a remainder tree,
+	 * which then costs more than Horner's rule, of which every step multiplies by the small x_i.
+	 *
+	 * @param points
+	 * @param threads the number of threads to use, 0 for all the hardware has
+	 * @return vector<dint> a(points[i]) at index i
+	 */
+	vector<dint> dpoly::evaluate(span<const dint> points, size_t threads) const
+	{
+		vector<dint> values(points.size());
+
+		parallel_for(values.size(), threads, [&](size_t i) { values[i] = evaluate(points[i]); });
+
+		return values;
+	}
+
+	/**
+	 * @brief a(x_i) mod m for every point x_i, with a remainder tree
+	 *
+	 * @param points
+	 * @param modulus
+	 * @param threads the number of threads to use, 0 for all the hardware has
+	 * @return vector<dint> a(points[i]) mod m at index i
+	 * @pre{modulus > 0}
+	 */
+	vector<dint> dpoly::evaluate(span<const dint> points, const dint &modulus, size_t threads) const
+	{
+		return descend(mod(*this, modulus), points, modulus, threads);
+	}
+
+	/**
+	 * @brief the coefficients from the constant term up, as c x^i terms separated by a +
+	 */
+	string dpoly::toHexString() const
+	{
+		string r;
+
+		for (size_t i = 0; i < c.size(); i++)
+		{
+			if (c[i].bit_length() != 0)
+			{
+				if (!r.empty())
+				{
+					r += " +";
+				}
+
+				r += c[i].toHexString();
+				r += "x^";
+				r += to_string(i);
+			}
+		}
+
+		return r.empty() ? Nil.toHexString() : r;
+	}
+
+	dpoly dpoly::operator-() const
+	{
+		dpoly r{*this};
+
+		for (dint &x : r.c)
+		{
+			x = -x;
+		}
+
+		return r;
+	}
+
+	dpoly &dpoly::operator+=(const dpoly &a)
+	{
+		if (c.size() < a.c.size())
+		{
+			c.resize(a.c.size());
+		}
+
+		for (size_t i = 0; i < a.c.size(); i++)
+		{
+			c[i] += a.c[i];
+		}
+
+		normalize();
+
+		return *this;
+	}
+
+	dpoly &dpoly::operator-=(const dpoly &a)
+	{
+		if (c.size() < a.c.size())
+		{
+			c.resize(a.c.size());
+		}
+
+		for (size_t i = 0; i < a.c.size(); i++)
+		{
+			c[i] -= a.c[i];
+		}
+
+		normalize();
+
+		return *this;
+	}
+
+	dpoly &dpoly::operator*=(const dpoly &a)
+	{
+		return *this = multiply(*this, a, nullptr);
+	}
+
+	dpoly operator+(const dpoly &a, const dpoly &b)
+	{
+		dpoly r{a};
+		r += b;
+		return r;
+	}
+
+	dpoly operator-(const dpoly &a, const dpoly &b)
+	{
+		dpoly r{a};
+		r -= b;
+		return r;
+	}
+
+	dpoly operator*(const dpoly &a, const dpoly &b)
+	{
+		return dpoly::multiply(a, b, nullptr);
+	}
+
+	bool operator==(const dpoly &a, const dpoly &b)
+	{
+		return a.c == b.c;
+	}
+
+	/**
+	 * @brief the quotient and remainder of a by b, a = q b + r with deg r < deg b
+	 *
+	 * @param a
+	 * @param b
+	 * @param q
+	 * @param r
+	 * @pre{the leading coefficient of b is 1 or -1}
+	 */
+	void divrem(const dpoly &a, const dpoly &b, dpoly &q, dpoly &r)
+	{
+		dpoly::divide(a, b, q, r, nullptr);
+	}
+
+	/**
+	 * @brief every coefficient of a reduced into [0, m)
+	 *
+	 * @pre{m > 0}
+	 */
+	dpoly mod(const dpoly &a, const dint &m)
+	{
+		dpoly r{a};
+
+		for (dint &x : r.c)
+		{
+			x = reduce(x, m);
+		}
+
+		r.normalize();
+
+		return r;
+	}
+
+	/**
+	 * @brief a b with the coefficients modulo m
+	 *
+	 * @pre{m > 0}
+	 */
+	dpoly mulmod(const dpoly &a, const dpoly &b, const dint &m)
+	{
+		return dpoly::multiply(mod(a, m), mod(b, m), &m);
+	}
+
+	/**
+	 * @brief the quotient and remainder of a by b with the coefficients modulo m
+	 *
+	 * @param a
+	 * @param b
+	 * @param q
+	 * @param r
+	 * @param m
+	 * @pre{m > 0 and the leading coefficient of b modulo m is invertible}
+	 */
+	void divrem(const dpoly &a, const dpoly &b, dpoly &q, dpoly &r, const dint &m)
+	{
+		dpoly::divide(mod(a, m), mod(b, m), q, r, &m);
+	}
+} // namespace bigint
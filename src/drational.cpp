@@ -0,0 +1,326 @@
+#include "drational.h"
+#include "tuning.h"
+
+namespace bigint
+{
+	static bool is_one(const dint &x)
+	{
+		return x.size() == 1 && static_cast<unsigned long long>(x) == 1 && !x.neg();
+	}
+
+	/**
+	 * @param numerator
+	 * @param denominator
+	 * @pre{denominator != 0}
+	 */
+	drational::drational(const dint &numerator, const dint &denominator) : num{numerator}, den{denominator}
+	{
+		if (den.bit_length() == 0)
+		{
+			throw domain_error("division by zero");
+		}
+
+		if (den.neg())
+		{
+			num = -num;
+			den = -den;
+		}
+
+		canonical = is_one(den);
+	}
+
+	/**
+	 * @brief divides out the gcd of the numerator and the denominator
+	 */
+	void drational::canonicalize()
+	{
+		if (canonical)
+		{
+			return;
+		}
+
+		const dint g = gcd(num, den);
+
+		if (!is_one(g))
+		{
+			num = divexact(num, g);
+			den = divexact(den, g);
+		}
+
+		canonical = true;
+	}
+
+	bool drational::is_canonical() const
+	{
+		return canonical;
+	}
+
+	/**
+	 * @brief x if it is reduced already, otherwise tmp set to x reduced
+	 */
+	const drational &drational::reduced(const drational &x, drational &tmp)
+	{
+		if (x.canonical)
+		{
+			return x;
+		}
+
+		tmp = x;
+		tmp.canonicalize();
+
+		return tmp;
+	}
+
+	dint drational::numerator() const
+	{
+		drational tmp;
+		return reduced(*this, tmp).num;
+	}
+
+	dint drational::denominator() const
+	{
+		drational tmp;
+		return reduced(*this, tmp).den;
+	}
+
+	/**
+	 * @brief whether a result of about this many words is reduced
+	 */
+	bool drational::too_big(size_t words) const
+	{
+		return words > tuning.rational;
+	}
+
+	/**
+	 * @brief a + b or a - b.
+	 * Small results are cross multiplied, a d + b c over b d, or added directly over a common denominator.
+	 * Larger ones use Henrici's method on the reduced fractions: with g = gcd(b, d) the sum is t = a (d / g) + c (b / g)
+	 * over (b / g) d, and only gcd(t, g) can be left in it.
+	 *
+	 * @param x
+	 * @param y
+	 * @param negate substract y instead of adding it
+	 */
+	drational drational::add(const drational &x, const drational &y, bool negate)
+	{
+		drational r;
+
+		dint c = negate ? -y.num : y.num;
+
+		if (x.den == y.den)
+		{
+			r.num		= x.num + c;
+			r.den		= x.den;
+			r.canonical = is_one(r.den);
+		}
+		else if (!x.too_big(max(x.num.size() + y.den.size(), y.num.size() + x.den.size()) + x.den.size() + y.den.size()))
+		{
+			r.num		= x.num * y.den + c * x.den;
+			r.den		= x.den * y.den;
+			r.canonical = false;
+		}
+		else
+		{
+			drational tx, ty;
+			const drational &a = reduced(x, tx);
+			const drational &b = reduced(y, ty);
+
+			c = negate ? -b.num : b.num;
+
+			const dint g = gcd(a.den, b.den);
+
+			if (is_one(g))
+			{
+				r.num = a.num * b.den + c * a.den;
+				r.den = a.den * b.den;
+			}
+			else
+			{
+				const dint bg = divexact(a.den, g);
+				const dint t  = a.num * divexact(b.den, g) + c * bg;
+				const dint h  = gcd(t, g);
+
+				r.num = divexact(t, h);
+				r.den = bg * divexact(b.den, h);
+			}
+
+			r.canonical = true;
+		}
+
+		if (r.num.bit_length() == 0)
+		{
+			r.den		= dint{1ULL};
+			r.canonical = true;
+		}
+
+		return r;
+	}
+
+	/**
+	 * @brief x y or x / y.
+	 * Small results are a c over b d. Larger ones use Henrici's method on the reduced fractions, the gcds of a with d
+	 * and of c with b are divided out before multiplying, which leaves the product reduced.
+	 *
+	 * @param x
+	 * @param y
+	 * @param invert divide by y instead of multiplying
+	 * @pre{when invert, y != 0}
+	 */
+	drational drational::multiply(const drational &x, const drational &y, bool invert)
+	{
+		if (invert && y.num.bit_length() == 0)
+		{
+			throw domain_error("division by zero");
+		}
+
+		// y or 1 / y as c / d with d > 0
+		dint c = invert ? y.den : y.num;
+		dint d = invert ? y.num : y.den;
+
+		if (d.neg())
+		{
+			c = -c;
+			d = -d;
+		}
+
+		drational r;
+
+		if (!x.too_big(x.num.size() + x.den.size() + c.size() + d.size()))
+		{
+			r.num		= x.num * c;
+			r.den		= x.den * d;
+			r.canonical = is_one(r.den) || r.num.bit_length() == 0;
+
+			if (r.num.bit_length() == 0)
+			{
+				r.den = dint{1ULL};
+			}
+
+			return r;
+		}
+
+		drational tx, ty;
+		const drational &a = reduced(x, tx);
+		const drational &b = reduced(y, ty);
+
+		// The reduced y
+		c = invert ? b.den : b.num;
+		d = invert ? b.num : b.den;
+
+		if (d.neg())
+		{
+			c = -c;
+			d = -d;
+		}
+
+		const dint g1 = gcd(a.num, d);
+		const dint g2 = gcd(c, a.den);
+
+		r.num		= divexact(a.num, g1) * divexact(c, g2);
+		r.den		= divexact(a.den, g2) * divexact(d, g1);
+		r.canonical = true;
+
+		return r;
+	}
+
+	drational drational::operator-() const
+	{
+		drational r{*this};
+		r.num = -r.num;
+		return r;
+	}
+
+	drational &drational::operator+=(const drational &a)
+	{
+		return *this = add(*this, a, false);
+	}
+
+	drational &drational::operator-=(const drational &a)
+	{
+		return *this = add(*this, a, true);
+	}
+
+	drational &drational::operator*=(const drational &a)
+	{
+		return *this = multiply(*this, a, false);
+	}
+
+	drational &drational::operator/=(const drational &a)
+	{
+		return *this = multiply(*this, a, true);
+	}
+
+	drational operator+(const drational &a, const drational &b)
+	{
+		return drational::add(a, b, false);
+	}
+
+	drational operator-(const drational &a, const drational &b)
+	{
+		return drational::add(a, b, true);
+	}
+
+	drational operator*(const drational &a, const drational &b)
+	{
+		return drational::multiply(a, b, false);
+	}
+
+	drational operator/(const drational &a, const drational &b)
+	{
+		return drational::multiply(a, b, true);
+	}
+
+	/**
+	 * @brief three way comparison, both fractions are reduced first and then cross multiplied
+	 *
+	 * @return int < 0, 0 or > 0 when a is less than, equal to or greater than b
+	 */
+	int compare(const drational &x, const drational &y)
+	{
+		drational tx, ty;
+		const drational &a = drational::reduced(x, tx);
+		const drational &b = drational::reduced(y, ty);
+
+		if (a.den == b.den)
+		{
+			return compare(a.num, b.num);
+		}
+
+		return compare(a.num * b.den, b.num * a.den);
+	}
+
+	bool operator==(const drational &x, const drational &y)
+	{
+		drational tx, ty;
+		const drational &a = drational::reduced(x, tx);
+		const drational &b = drational::reduced(y, ty);
+
+		// Lowest terms are unique
+		return a.num == b.num && a.den == b.den;
+	}
+
+	strong_ordering operator<=>(const drational &a, const drational &b)
+	{
+		return compare(a, b) <=> 0;
+	}
+
+	/**
+	 * @brief the fraction rounded to the nearest dfloat of the given precision
+	 */
+	dfloat drational::to_dfloat(size_t precision) const
+	{
+		// Both convert exactly, so the division rounds only once
+		return div(dfloat{num, max<size_t>(num.bit_length(), 1)}, dfloat{den, den.bit_length()}, precision);
+	}
+
+	/**
+	 * @brief the reduced numerator and denominator in hex, separated by a /
+	 */
+	string drational::toHexString() const
+	{
+		drational tmp;
+		const drational &r = reduced(*this, tmp);
+
+		return r.num.toHexString() + "/" + r.den.toHexString();
+	}
+} // namespace bigint
@@ -0,0 +1,529 @@
+#include "dint.h"
+#include "tuning.h"
+
+// Extra bits kept above the halfway point by the half gcd, so the steps found on the top halves stay valid for the whole numbers
+constexpr size_t hgcd_margin = 16;
+
+namespace bigint
+{
+	/**
+	 * @brief The product of the Euclidean steps done so far.
+	 * (a, b) = M (a', b') where (a, b) are the original numbers and (a', b') the current ones.
+	 * Every step is M = M * [[q, 1], [1, 0]] so all entries are non-negative and det(M) = (-1)^steps.
+	 */
+	struct dint::cofactors
+	{
+		dint m00{1ULL}, m01{0ULL};
+		dint m10{0ULL}, m11{1ULL};
+
+		// det(M) == -1
+		bool odd{false};
+
+		bool identity() const
+		{
+			return m01 == Nil && m10 == Nil && !odd && m00 == dint{1ULL};
+		}
+
+		/**
+		 * @brief M = M * [[q, 1], [1, 0]]
+		 */
+		void push(const dint &q)
+		{
+			dint t00 = m00 * q + m01;
+			dint t10 = m10 * q + m11;
+
+			m01 = move(m00);
+			m11 = move(m10);
+			m00 = move(t00);
+			m10 = move(t10);
+
+			odd = !odd;
+		}
+
+		/**
+		 * @brief M = M * N
+		 */
+		void push(const cofactors &n)
+		{
+			dint t00 = m00 * n.m00 + m01 * n.m10;
+			dint t01 = m00 * n.m01 + m01 * n.m11;
+			dint t10 = m10 * n.m00 + m11 * n.m10;
+			dint t11 = m10 * n.m01 + m11 * n.m11;
+
+			m00 = move(t00);
+			m01 = move(t01);
+			m10 = move(t10);
+			m11 = move(t11);
+
+			odd = odd != n.odd;
+		}
+	};
+
+	static bool is_zero(const dint &a)
+	{
+		return a.size() == 1 && a.front() == 0;
+	}
+
+	static bool fits_word(const dint &a)
+	{
+		return a.size() <= sizeof(unsigned long long) / sizeof(base);
+	}
+
+	/**
+	 * @brief binary gcd of two machine words
+	 */
+	static unsigned long long binary_gcd(unsigned long long a, unsigned long long b)
+	{
+		if (a == 0)
+		{
+			return b;
+		}
+		if (b == 0)
+		{
+			return a;
+		}
+
+		int k = countr_zero(a | b);
+
+		a >>= countr_zero(a);
+
+		while (b != 0)
+		{
+			b >>= countr_zero(b);
+
+			if (a > b)
+			{
+				swap(a, b);
+			}
+
+			b -= a;
+		}
+
+		return a << k;
+	}
+
+	/**
+	 * @brief (a, b) = M^-1 (a, b), the result has to be non-negative and decreasing
+	 *
+	 * @return true if (a, b) was updated
+	 */
+	bool dint::apply_inverse(const cofactors &m, dint &a, dint &b)
+	{
+		// M^-1 = det(M) [[m11, -m01], [-m10, m00]]
+		dint pa = m.m11 * a;
+		dint na = m.m01 * b;
+		dint pb = m.m00 * b;
+		dint nb = m.m10 * a;
+
+		if (m.odd)
+		{
+			swap(pa, na);
+			swap(pb, nb);
+		}
+
+		if (abslst(pa, na) || abslst(pb, nb))
+		{
+			return false;
+		}
+
+		subabs(pa, na, pa);
+		subabs(pb, nb, pb);
+
+		if (abslst(pa, pb))
+		{
+			return false;
+		}
+
+		a = move(pa);
+		b = move(pb);
+
+		return true;
+	}
+
+	/**
+	 * @brief (a, b) = (b, a mod b)
+	 */
+	void dint::euclid_step(dint &a, dint &b, cofactors *m)
+	{
+		dint q, r;
+
+		divmod(a, b, q, r);
+
+		a = move(b);
+		b = move(r);
+
+		if (m != nullptr)
+		{
+			m->push(q);
+		}
+	}
+
+	/**
+	 * @brief A sequence of Euclidean steps determined only from the leading 62 bits of a and b (Knuth, TAOCP vol 2, algorithm L)
+	 *
+	 * @return false if no step could be determined, a and b are unchanged
+	 * @pre{a >= b}
+	 */
+	bool dint::lehmer_step(dint &a, dint &b, cofactors *m)
+	{
+		// The cofactors are bounded by the leading bits so everything below fits in a signed word
+		constexpr size_t lead_bits = 62;
+
+		size_t n = a.bit_length();
+		size_t p = n > lead_bits ? n - lead_bits : 0;
+
+		long long x = static_cast<long long>(static_cast<unsigned long long>(a >> p));
+		long long y = static_cast<long long>(static_cast<unsigned long long>(b >> p));
+
+		long long A = 1, B = 0, C = 0, D = 1;
+		size_t steps = 0;
+
+		while (y + C > 0 && y + D > 0)
+		{
+			long long q = (x + A) / (y + C);
+
+			if (q == 0 || q != (x + B) / (y + D))
+			{
+				break;
+			}
+
+			long long t;
+
+			t = A - q * C;
+			A = C;
+			C = t;
+
+			t = B - q * D;
+			B = D;
+			D = t;
+
+			t = x - q * y;
+			x = y;
+			y = t;
+
+			steps++;
+		}
+
+		if (B == 0)
+		{
+			return false;
+		}
+
+		// (a, b) = (A a + B b, C a + D b), where the signs alternate and the results are non-negative
+		auto combine = [&](long long u, long long v)
+		{
+			dint s = a * dint{static_cast<unsigned long long>(u < 0 ? -u : u)};
+			dint t = b * dint{static_cast<unsigned long long>(v < 0 ? -v : v)};
+
+			if (abslst(s, t))
+			{
+				subabs(t, s, t);
+				return t;
+			}
+
+			subabs(s, t, s);
+			return s;
+		};
+
+		dint na = combine(A, B);
+		dint nb = combine(C, D);
+
+		a = move(na);
+		b = move(nb);
+
+		if (m != nullptr)
+		{
+			// [[A, B], [C, D]]^-1 = [[|D|, |B|], [|C|, |A|]]
+			cofactors n;
+			n.m00 = dint{static_cast<unsigned long long>(D < 0 ? -D : D)};
+			n.m01 = dint{static_cast<unsigned long long>(B < 0 ? -B : B)};
+			n.m10 = dint{static_cast<unsigned long long>(C < 0 ? -C : C)};
+			n.m11 = dint{static_cast<unsigned long long>(A < 0 ? -A : A)};
+			n.odd = steps % 2 == 1;
+
+			m->push(n);
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief Half gcd, reduces a and b to about half their size with the Euclidean steps found by recursing on the top halves.
+	 * Only steps that keep both numbers above 2^(n/2 + margin) are taken, that way the steps of the top halves
+	 * are also steps of the whole numbers.
+	 *
+	 * @param a
+	 * @param b
+	 * @param m the steps taken, starts as the identity
+	 * @pre{a >= b}
+	 * @post{a >= b}
+	 */
+	void dint::hgcd(dint &a, dint &b, cofactors &m)
+	{
+		const size_t n	  = a.bit_length();
+		const size_t stop = n / 2 + hgcd_margin;
+
+		if (b.bit_length() <= stop)
+		{
+			return;
+		}
+
+		// Recursion on the top bits of a and b, the steps are only kept if they are valid for a and b themselves
+		auto top = [&](size_t k)
+		{
+			dint ta = a >> k;
+			dint tb = b >> k;
+
+			cofactors r;
+			hgcd(ta, tb, r);
+
+			if (r.identity())
+			{
+				return;
+			}
+
+			dint na{a}, nb{b};
+
+			if (apply_inverse(r, na, nb) && nb.bit_length() > stop)
+			{
+				a = move(na);
+				b = move(nb);
+				m.push(r);
+			}
+		};
+
+		// A single step (or a batch of Lehmer steps) if the remainder stays above the stop
+		auto step = [&]()
+		{
+			if (b.bit_length() <= stop)
+			{
+				return false;
+			}
+
+			if (!fits_word(b))
+			{
+				dint ta{a}, tb{b};
+				cofactors r;
+
+				if (lehmer_step(ta, tb, &r) && tb.bit_length() > stop)
+				{
+					a = move(ta);
+					b = move(tb);
+					m.push(r);
+					return true;
+				}
+			}
+
+			dint q, r;
+			divmod(a, b, q, r);
+
+			if (r.bit_length() <= stop)
+			{
+				return false;
+			}
+
+			a = move(b);
+			b = move(r);
+			m.push(q);
+
+			return true;
+		};
+
+		if (a.size() >= tuning.hgcd)
+		{
+			// The top half of n bits reduces to about 3n/4 bits
+			top(n / 2);
+
+			// Makes sure there is progress even if the top half did not give any steps
+			if (step())
+			{
+				// From k bits to the stop needs a top part of 2 (k - stop) bits, which should be clearly smaller than n
+				size_t k = a.bit_length();
+
+				if (b.bit_length() > stop && 4 * (k - stop) <= 3 * n)
+				{
+					top(2 * stop - k);
+				}
+			}
+		}
+
+		while (step())
+		{
+		}
+	}
+
+	/**
+	 * @brief Reduces (a, b) to (gcd(a, b), 0)
+	 *
+	 * @param a
+	 * @param b
+	 * @param m if not nullptr the steps taken are added to this
+	 * @pre{a >= b >= 0}
+	 */
+	void dint::reduce(dint &a, dint &b, cofactors *m)
+	{
+		while (!is_zero(b))
+		{
+			if (m == nullptr && fits_word(a))
+			{
+				a = dint{binary_gcd(static_cast<unsigned long long>(a), static_cast<unsigned long long>(b))};
+				b = dint{};
+				return;
+			}
+
+			if (b.size() >= tuning.hgcd)
+			{
+				cofactors r;
+				hgcd(a, b, r);
+
+				if (m != nullptr)
+				{
+					m->push(r);
+				}
+
+				// hgcd stops short of its halfway point, one division step guarantees progress
+				euclid_step(a, b, m);
+			}
+			else if (fits_word(b) || a.size() > b.size() + 1 || !lehmer_step(a, b, m))
+			{
+				euclid_step(a, b, m);
+			}
+		}
+	}
+
+	/**
+	 * @brief greatest common divisor
+	 *
+	 * @param a
+	 * @param b
+	 * @return dint gcd(|a|, |b|), gcd(0, 0) = 0
+	 */
+	dint gcd(const dint &a, const dint &b)
+	{
+		BIGINT_STAT(counters.count(stats::gcd, max(a.size(), b.size()));)
+
+		dint x{a}, y{b};
+
+		x.negative = false;
+		y.negative = false;
+
+		if (x < y)
+		{
+			swap(x, y);
+		}
+
+		dint::reduce(x, y, nullptr);
+
+		return x;
+	}
+
+	/**
+	 * @brief least common multiple
+	 *
+	 * @param a
+	 * @param b
+	 * @return dint lcm(|a|, |b|), 0 if a or b is 0
+	 */
+	dint lcm(const dint &a, const dint &b)
+	{
+		if (is_zero(a) || is_zero(b))
+		{
+			return dint{};
+		}
+
+		dint r = (a / gcd(a, b)) * b;
+		r.negative = false;
+
+		return r;
+	}
+
+	/**
+	 * @brief extended gcd
+	 *
+	 * @param a
+	 * @param b
+	 * @param s
+	 * @param t
+	 * @return dint g = gcd(a, b)
+	 * @post{g = s * a + t * b}
+	 */
+	dint gcdext(const dint &a, const dint &b, dint &s, dint &t)
+	{
+		dint x{a}, y{b};
+
+		x.negative = false;
+		y.negative = false;
+
+		bool swapped = x < y;
+
+		if (swapped)
+		{
+			swap(x, y);
+		}
+
+		if (is_zero(x))
+		{
+			s = dint{};
+			t = dint{};
+			return x;
+		}
+
+		dint::cofactors m;
+
+		dint::reduce(x, y, &m);
+
+		// (gcd, 0) = M^-1 (x, y) = det(M) [[m11, -m01], [-m10, m00]] (x, y)
+		dint cx{m.m11};
+		dint cy{m.m01};
+
+		cx.negative = m.odd && !is_zero(cx);
+		cy.negative = !m.odd && !is_zero(cy);
+
+		if (swapped)
+		{
+			swap(cx, cy);
+		}
+
+		cx.negative = cx.negative != (a.negative && !is_zero(cx));
+		cy.negative = cy.negative != (b.negative && !is_zero(cy));
+
+		s = move(cx);
+		t = move(cy);
+
+		return x;
+	}
+
+	/**
+	 * @brief modular inverse
+	 *
+	 * @param a
+	 * @param m the modulus
+	 * @return dint x in [0, |m|) with a x = 1 (mod m)
+	 * @throw domain_error if a is not invertible modulo m
+	 */
+	dint invmod(const dint &a, const dint &m)
+	{
+		dint mod{m};
+		mod.negative = false;
+
+		dint s, t;
+		dint g = gcdext(a % mod, mod, s, t);
+
+		if (g != dint{1ULL})
+		{
+			throw domain_error("not invertible");
+		}
+
+		if (mod == dint{1ULL})
+		{
+			return dint{};
+		}
+
+		if (s.negative)
+		{
+			dint::subabs(mod, s, s);
+		}
+
+		return s;
+	}
+} // namespace bigint
@@ -0,0 +1,57 @@
+#include "dint.h"
+
+namespace bigint
+{
+	// Odd constants with well mixed bits, one per lane
+	constexpr uint64_t keys[] = {0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL,
+								 0xD6E8FEB86659FD93ULL};
+
+	/**
+	 * @brief the full 128 bit product folded to 64 bits, every input bit reaches every output bit
+	 */
+	inline uint64_t fold(uint64_t a, uint64_t b)
+	{
+		unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+		return static_cast<uint64_t>(p) ^ static_cast<uint64_t>(p >> 64);
+	}
+
+	/**
+	 * @brief Hash of the value, equal numbers have equal hashes.
+	 * The words are read as machine words in four independent lanes, so the multiplications of one
+	 * lane overlap with the others, and the lanes are folded together at the end.
+	 *
+	 * @return size_t
+	 */
+	size_t dint::hash() const
+	{
+		const base *p = data.data();
+		const size_t n = size();
+
+		uint64_t h[4] = {keys[0] ^ n, keys[1], keys[2], keys[3]};
+
+		constexpr size_t lanes = 4;
+		constexpr size_t block = lanes * word_size;
+
+		size_t i = 0;
+
+		for (; i + block <= n; i += block)
+		{
+			for (size_t j = 0; j < lanes; j++)
+			{
+				h[j] = fold(h[j] ^ load_word(p + i + j * word_size, word_size), keys[j]);
+			}
+		}
+
+		for (size_t j = 0; i < n; i += word_size, j++)
+		{
+			h[j] = fold(h[j] ^ load_word(p + i, min(word_size, n - i)), keys[j]);
+		}
+
+		// Zero is not negative, whatever its sign says
+		bool sign = negative && !(n == 1 && p[0] == 0);
+
+		uint64_t x = fold(h[0] ^ h[2], h[1] ^ h[3] ^ keys[0]);
+
+		return fold(x ^ sign, keys[1]);
+	}
+} // namespace bigint
@@ -0,0 +1,498 @@
+#include "mapped_dint.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <utility>
+
+namespace bigint
+{
+	// A product in memory takes about this many times the words of the tile it is done on: the operands, the result
+	// and the scratch buffer of karatsuba
+	constexpr size_t words_per_tile = 12;
+
+	// Tiles are never smaller than this many words, whatever the memory budget
+	constexpr size_t min_tile = 64;
+
+	mapped_dint::mapped_dint(const string &path, bool writable) : path{path}, writable{writable}
+	{
+		fd = open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+
+		if (fd < 0)
+		{
+			throw runtime_error("cannot open " + path);
+		}
+
+		struct stat st;
+
+		if (fstat(fd, &st) != 0)
+		{
+			close(fd);
+			throw runtime_error("cannot open " + path);
+		}
+
+		try
+		{
+			map(st.st_size / sizeof(base));
+		}
+		catch (...)
+		{
+			close(fd);
+			throw;
+		}
+	}
+
+	mapped_dint::mapped_dint(const string &path, const dint &a) : path{path}, writable{true}
+	{
+		fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+		if (fd < 0)
+		{
+			throw runtime_error("cannot create " + path);
+		}
+
+		try
+		{
+			resize(a.size());
+		}
+		catch (...)
+		{
+			close(fd);
+			throw;
+		}
+
+		std::copy(a.data.begin(), a.data.end(), p);
+	}
+
+	/**
+	 * @brief takes a file that is open for reading and writing, and empty
+	 */
+	mapped_dint::mapped_dint(int fd) : path{"scratch file"}, fd{fd}, writable{true} {}
+
+	mapped_dint::mapped_dint(mapped_dint &&other) noexcept
+		: path{move(other.path)}, fd{exchange(other.fd, -1)}, p{exchange(other.p, nullptr)}, n{exchange(other.n, 0)},
+		  writable{other.writable}
+	{
+	}
+
+	mapped_dint &mapped_dint::operator=(mapped_dint &&other) noexcept
+	{
+		swap(path, other.path);
+		swap(fd, other.fd);
+		swap(p, other.p);
+		swap(n, other.n);
+		swap(writable, other.writable);
+
+		return *this;
+	}
+
+	mapped_dint::~mapped_dint()
+	{
+		unmap();
+
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+	}
+
+	size_t mapped_dint::size() const
+	{
+		return n;
+	}
+
+	const base *mapped_dint::data() const
+	{
+		return p;
+	}
+
+	base *mapped_dint::data()
+	{
+		return p;
+	}
+
+	/**
+	 * @throw runtime_error if the file was mapped read only or can not be resized
+	 */
+	void mapped_dint::resize(size_t words)
+	{
+		if (!writable)
+		{
+			throw runtime_error(path + " is mapped read only");
+		}
+
+		unmap();
+
+		if (ftruncate(fd, static_cast<off_t>(words * sizeof(base))) != 0)
+		{
+			throw runtime_error("cannot resize " + path);
+		}
+
+		map(words);
+	}
+
+	dint mapped_dint::to_dint() const
+	{
+		dint r;
+		load(p, n, r);
+
+		return r;
+	}
+
+	void mapped_dint::map(size_t words)
+	{
+		n = words;
+
+		// mmap does not take empty mappings
+		if (n == 0)
+		{
+			return;
+		}
+
+		void *m = mmap(nullptr, n * sizeof(base), writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+
+		if (m == MAP_FAILED)
+		{
+			n = 0;
+			throw runtime_error("cannot map " + path);
+		}
+
+		p = static_cast<base *>(m);
+	}
+
+	void mapped_dint::unmap()
+	{
+		if (p)
+		{
+			munmap(p, n * sizeof(base));
+		}
+
+		p = nullptr;
+		n = 0;
+	}
+
+	/**
+	 * @brief a file of the given number of zero words in the scratch directory, removed from the directory already so it
+	 * is gone once it is unmapped
+	 */
+	mapped_dint mapped_dint::scratch(const schedule &s, size_t words)
+	{
+		string name = s.directory + "bigintXXXXXX";
+
+		const int fd = mkstemp(name.data());
+
+		if (fd < 0)
+		{
+			throw runtime_error("cannot create a scratch file in " + (s.directory.empty() ? "." : s.directory));
+		}
+
+		unlink(name.c_str());
+
+		mapped_dint r{fd};
+		r.resize(words);
+
+		return r;
+	}
+
+	/**
+	 * @brief passes an madvise hint for the pages that hold any of the n words at p.
+	 * Dropping a page that is shared with a neighbouring range is harmless: every mapping is a shared file mapping, so the
+	 * page is read back from the page cache or the file.
+	 */
+	void mapped_dint::advise(const base *p, size_t n, int advice)
+	{
+		if (n == 0)
+		{
+			return;
+		}
+
+		static const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+
+		const uintptr_t first = reinterpret_cast<uintptr_t>(p) / page * page;
+		const uintptr_t last  = (reinterpret_cast<uintptr_t>(p + n) + page - 1) / page * page;
+
+		// Only a hint, an error changes nothing about the result
+		madvise(reinterpret_cast<void *>(first), last - first, advice);
+	}
+
+	/**
+	 * @brief x = the n words at p
+	 */
+	void mapped_dint::load(const base *p, size_t n, dint &x)
+	{
+		x.negative = false;
+
+		if (n == 0)
+		{
+			x.data.assign(1, 0);
+			return;
+		}
+
+		x.data.assign(p, p + n);
+		x.remove_leading_zeros();
+	}
+
+	/**
+	 * @brief writes the lowest n words of x to p, padded with zeros
+	 */
+	void mapped_dint::store(const dint &x, base *p, size_t n)
+	{
+		const size_t k = min(n, x.data.size());
+
+		std::copy(x.data.begin(), x.data.begin() + k, p);
+		fill(p + k, p + n, 0);
+	}
+
+	/**
+	 * @brief sets the n words at p to 0, a tile at a time
+	 */
+	void mapped_dint::fill_zero(base *p, size_t n, const schedule &s)
+	{
+		for (size_t i = 0; i < n; i += s.tile)
+		{
+			const size_t e = min(n, i + s.tile);
+
+			fill(p + i, p + e, 0);
+			advise(p + i, e - i, MADV_DONTNEED);
+		}
+	}
+
+	/**
+	 * @brief the nd words at dest = the nx words at x, padded with zeros, a tile at a time
+	 *
+	 * @pre{nx <= nd}
+	 */
+	void mapped_dint::copy(const base *x, size_t nx, base *dest, size_t nd, const schedule &s)
+	{
+		for (size_t i = 0; i < nx; i += s.tile)
+		{
+			const size_t e = min(nx, i + s.tile);
+
+			advise(x + e, min(s.tile, nx - e), MADV_WILLNEED);
+
+			std::copy(x + i, x + e, dest + i);
+
+			advise(x + i, e - i, MADV_DONTNEED);
+			advise(dest + i, e - i, MADV_DONTNEED);
+		}
+
+		fill_zero(dest + nx, nd - nx, s);
+	}
+
+	/**
+	 * @brief adds or substracts the nx words at x to or from the nd words at dest, a tile at a time.
+	 * The next tile is prefetched while one is done, and the tiles that are done are dropped from memory.
+	 * Words of x past nd must be 0.
+	 *
+	 * @return true if a carry or borrow comes out of the top of dest
+	 */
+	bool mapped_dint::accumulate(base *dest, size_t nd, const base *x, size_t nx, bool subtract, const schedule &s)
+	{
+		bool carry = false;
+
+		nx = min(nx, nd);
+
+		for (size_t i = 0; i < nd && (i < nx || carry); i += s.tile)
+		{
+			const size_t e = min(nd, i + s.tile);
+
+			advise(dest + e, min(s.tile, nd - e), MADV_WILLNEED);
+
+			if (e < nx)
+			{
+				advise(x + e, min(s.tile, nx - e), MADV_WILLNEED);
+			}
+
+			for (size_t k = i; k < e && (k < nx || carry); k += dint::word_size)
+			{
+				const size_t w = min(dint::word_size, e - k);
+
+				const uint64_t a = dint::load_word(dest + k, w);
+				const uint64_t b = k < nx ? dint::load_word(x + k, min(w, nx - k)) : 0;
+
+				uint64_t r;
+				bool out;
+
+				if (subtract)
+				{
+					out = __builtin_sub_overflow(a, b, &r) | __builtin_sub_overflow(r, uint64_t{carry}, &r);
+				}
+				else
+				{
+					out = __builtin_add_overflow(a, b, &r) | __builtin_add_overflow(r, uint64_t{carry}, &r);
+				}
+
+				// A partial word carries into the bits above its words
+				if (w < dint::word_size)
+				{
+					out = (r >> (w * bits_per_word)) != 0;
+				}
+
+				dint::store_word(dest + k, r, w);
+				carry = out;
+			}
+
+			advise(dest + i, e - i, MADV_DONTNEED);
+
+			if (i < nx)
+			{
+				advise(x + i, min(e, nx) - i, MADV_DONTNEED);
+			}
+		}
+
+		return carry;
+	}
+
+	/**
+	 * @brief the na + nb words at dest = a b.
+	 * A factor that fits in a tile stays in memory while the other one streams past it a tile at a time, the high
+	 * words of each product carried into the next. A larger one cuts the other in pieces of its size, whose products
+	 * are done by karatsuba and added into dest.
+	 */
+	void mapped_dint::multiply(const base *a, size_t na, const base *b, size_t nb, base *dest, const schedule &s)
+	{
+		if (na < nb)
+		{
+			swap(a, b);
+			swap(na, nb);
+		}
+
+		if (nb <= s.tile)
+		{
+			dint x, y, high, r;
+
+			advise(b, nb, MADV_WILLNEED);
+			load(b, nb, y);
+
+			for (size_t i = 0; i < na; i += s.tile)
+			{
+				const size_t len = min(s.tile, na - i);
+
+				advise(a + i + len, min(s.tile, na - i - len), MADV_WILLNEED);
+
+				load(a + i, len, x);
+				advise(a + i, len, MADV_DONTNEED);
+
+				mult(x, y, r);
+				r += high;
+
+				store(r, dest + i, len);
+				advise(dest + i, len, MADV_DONTNEED);
+
+				r.shiftwordsright(len);
+				swap(high, r);
+			}
+
+			store(high, dest + na, nb);
+			advise(b, nb, MADV_DONTNEED);
+
+			return;
+		}
+
+		fill_zero(dest, na + nb, s);
+
+		mapped_dint product = scratch(s, 2 * nb);
+
+		for (size_t i = 0; i < na; i += nb)
+		{
+			const size_t len = min(nb, na - i);
+
+			if (len == nb)
+			{
+				karatsuba(a + i, b, nb, product.p, s);
+			}
+			else
+			{
+				multiply(b, nb, a + i, len, product.p, s);
+			}
+
+			accumulate(dest + i, na + nb - i, product.p, len + nb, false, s);
+		}
+	}
+
+	/**
+	 * @brief the 2n words at dest = a b, for a and b of n words.
+	 * Karatsuba over files: the halves are multiplied into the two halves of dest, the product of the sums into a
+	 * scratch file, and the middle term is then made and added in by streaming passes. Once the operands fit in a tile
+	 * they are multiplied in memory by mult.
+	 */
+	void mapped_dint::karatsuba(const base *a, const base *b, size_t n, base *dest, const schedule &s)
+	{
+		if (n <= s.tile)
+		{
+			advise(a, n, MADV_WILLNEED);
+			advise(b, n, MADV_WILLNEED);
+
+			dint x, y, r;
+			load(a, n, x);
+			load(b, n, y);
+
+			advise(a, n, MADV_DONTNEED);
+			advise(b, n, MADV_DONTNEED);
+
+			mult(x, y, r);
+
+			store(r, dest, 2 * n);
+			advise(dest, 2 * n, MADV_DONTNEED);
+
+			return;
+		}
+
+		// a = a1 X^h + a0, with a1 the shorter half
+		const size_t h = (n + 1) / 2;
+		const size_t m = n - h;
+
+		karatsuba(a, b, h, dest, s);
+		karatsuba(a + h, b + h, m, dest + 2 * h, s);
+
+		mapped_dint z1 = scratch(s, 2 * h + 2);
+
+		{
+			mapped_dint sa = scratch(s, h + 1);
+			mapped_dint sb = scratch(s, h + 1);
+
+			copy(a, h, sa.p, h + 1, s);
+			accumulate(sa.p, h + 1, a + h, m, false, s);
+
+			copy(b, h, sb.p, h + 1, s);
+			accumulate(sb.p, h + 1, b + h, m, false, s);
+
+			karatsuba(sa.p, sb.p, h + 1, z1.p, s);
+		}
+
+		// z1 = a0 b1 + a1 b0 < 2 X^n, which fits in the 2n - h words above X^h
+		accumulate(z1.p, 2 * h + 2, dest, 2 * h, true, s);
+		accumulate(z1.p, 2 * h + 2, dest + 2 * h, 2 * m, true, s);
+
+		accumulate(dest + h, 2 * n - h, z1.p, 2 * h + 2, false, s);
+	}
+
+	/**
+	 * @brief dest = a b, with at most about memory bytes of the numbers in memory at a time.
+	 * The tiles are memory / 12 bytes, and the scratch files, about 10 times the size of the smaller operand in all, are
+	 * made in the directory of dest. The leaves are ordinary products, so they report to progress like mult.
+	 *
+	 * @param a
+	 * @param b
+	 * @param dest resized to a.size() + b.size() words
+	 * @param memory the budget in bytes, tiles are at least 64 words whatever it is
+	 * @pre{dest is writable and is not a or b}
+	 */
+	void mult(const mapped_dint &a, const mapped_dint &b, mapped_dint &dest, size_t memory)
+	{
+		size_t tile = max(memory / words_per_tile / sizeof(base), min_tile);
+
+		// Whole machine words, so only the last word of a range is partial
+		tile -= tile % (sizeof(uint64_t) / sizeof(base));
+
+		const size_t slash = dest.path.rfind('/');
+
+		const mapped_dint::schedule s{tile, slash == string::npos ? "" : dest.path.substr(0, slash + 1)};
+
+		dest.resize(a.size() + b.size());
+
+		mapped_dint::multiply(a.p, a.size(), b.p, b.size(), dest.p, s);
+	}
+} // namespace bigint
@@ -0,0 +1,382 @@
+#include "montgomery.h"
+#include "progress.h"
+
+namespace bigint
+{
+	using word = montgomery::word;
+
+	static bool is_zero(const dint &a)
+	{
+		return a.size() == 1 && a.front() == 0;
+	}
+
+	/**
+	 * @param m the modulus
+	 * @pre{m is odd and m > 1}
+	 */
+	montgomery::montgomery(const dint &m) : mod{m}
+	{
+		mod.negative = false;
+
+		constexpr size_t per_word = sizeof(word) / sizeof(base);
+
+		n = (mod.size() + per_word - 1) / per_word;
+		N = dint::to_words(mod, n);
+
+		// Newton's iteration for N^-1 mod 2^64, N * N = 1 (mod 8) so every step doubles the 3 correct bits
+		word inv = N[0];
+		for (int i = 0; i < 5; i++)
+		{
+			inv *= 2 - N[0] * inv;
+		}
+		ninv = -inv;
+
+		r0.assign(n, 0);
+		r1 = to(dint{1ULL});
+	}
+
+	/**
+	 * @brief x R mod N
+	 */
+	montgomery::words montgomery::to(const dint &x) const
+	{
+		dint r = x % mod;
+
+		if (r.neg())
+		{
+			dint::subabs(mod, r, r);
+		}
+
+		r <<= static_cast<unsigned int>(n * 64);
+		r %= mod;
+
+		return dint::to_words(r, n);
+	}
+
+	/**
+	 * @brief x R^-1 mod N, the number in Montgomery form back to a dint
+	 */
+	dint montgomery::from(const words &x) const
+	{
+		words one(n, 0);
+		one[0] = 1;
+
+		words r(n);
+		mul(x, one, r);
+
+		return dint::from_words(r);
+	}
+
+	bool montgomery::geq_modulus(const words &x) const
+	{
+		for (size_t i = n; i-- > 0;)
+		{
+			if (x[i] != N[i])
+			{
+				return x[i] > N[i];
+			}
+		}
+		return true;
+	}
+
+	void montgomery::sub_modulus(words &x) const
+	{
+		word borrow = 0;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			unsigned __int128 d = static_cast<unsigned __int128>(x[i]) - N[i] - borrow;
+
+			x[i]   = static_cast<word>(d);
+			borrow = static_cast<word>(d >> 64) & 1;
+		}
+	}
+
+	/**
+	 * @brief dest = a b R^-1 mod N (coarsely integrated operand scanning)
+	 *
+	 * @pre{a, b < N}
+	 * @post{dest < N}
+	 * @post{dest may be a or b}
+	 */
+	void montgomery::mul(const words &a, const words &b, words &dest) const
+	{
+		// Counted in products of the words of a dint
+		constexpr size_t per_word = sizeof(word) / sizeof(base);
+		progress::checkpoint(n * n * per_word * per_word);
+
+		// Scratch space per thread, so a context can be shared
+		thread_local words t;
+
+		if (t.size() < n + 2)
+		{
+			t.resize(n + 2);
+		}
+
+		fill(t.begin(), t.begin() + n + 2, word{0});
+
+		// Local copies, the writes to t could otherwise alias them
+		const size_t k = n;
+		const word q   = ninv;
+
+		const word *pa = a.data();
+		const word *pb = b.data();
+		const word *pn = N.data();
+		word *pt	   = t.data();
+
+		for (size_t i = 0; i < k; i++)
+		{
+			word c = 0;
+			unsigned __int128 p;
+
+			for (size_t j = 0; j < k; j++)
+			{
+				p	  = static_cast<unsigned __int128>(pa[j]) * pb[i] + pt[j] + c;
+				pt[j] = static_cast<word>(p);
+				c	  = static_cast<word>(p >> 64);
+			}
+
+			p		  = static_cast<unsigned __int128>(pt[k]) + c;
+			pt[k]	  = static_cast<word>(p);
+			pt[k + 1] = static_cast<word>(p >> 64);
+
+			// Adding m N makes the lowest word zero, which is then shifted out
+			const word m = pt[0] * q;
+
+			p = static_cast<unsigned __int128>(m) * pn[0] + pt[0];
+			c = static_cast<word>(p >> 64);
+
+			for (size_t j = 1; j < k; j++)
+			{
+				p		  = static_cast<unsigned __int128>(m) * pn[j] + pt[j] + c;
+				pt[j - 1] = static_cast<word>(p);
+				c		  = static_cast<word>(p >> 64);
+			}
+
+			p		  = static_cast<unsigned __int128>(pt[k]) + c;
+			pt[k - 1] = static_cast<word>(p);
+			pt[k]	  = pt[k + 1] + static_cast<word>(p >> 64);
+		}
+
+		dest.assign(t.begin(), t.begin() + k);
+
+		if (t[k] != 0 || geq_modulus(dest))
+		{
+			sub_modulus(dest);
+		}
+	}
+
+	/**
+	 * @brief dest = a + b mod N
+	 *
+	 * @pre{a, b < N}
+	 */
+	void montgomery::add(const words &a, const words &b, words &dest) const
+	{
+		dest.resize(n);
+
+		word c = 0;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			unsigned __int128 s = static_cast<unsigned __int128>(a[i]) + b[i] + c;
+
+			dest[i] = static_cast<word>(s);
+			c		= static_cast<word>(s >> 64);
+		}
+
+		if (c != 0 || geq_modulus(dest))
+		{
+			sub_modulus(dest);
+		}
+	}
+
+	/**
+	 * @brief dest = a - b mod N
+	 *
+	 * @pre{a, b < N}
+	 */
+	void montgomery::sub(const words &a, const words &b, words &dest) const
+	{
+		dest.resize(n);
+
+		word borrow = 0;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			unsigned __int128 d = static_cast<unsigned __int128>(a[i]) - b[i] - borrow;
+
+			dest[i] = static_cast<word>(d);
+			borrow	= static_cast<word>(d >> 64) & 1;
+		}
+
+		if (borrow != 0)
+		{
+			// Wrapped around 2^(64 n), adding N brings it back
+			word c = 0;
+
+			for (size_t i = 0; i < n; i++)
+			{
+				unsigned __int128 s = static_cast<unsigned __int128>(dest[i]) + N[i] + c;
+
+				dest[i] = static_cast<word>(s);
+				c		= static_cast<word>(s >> 64);
+			}
+		}
+	}
+
+	/**
+	 * @brief x = x / 2 mod N
+	 *
+	 * @pre{x < N}
+	 */
+	void montgomery::half(words &x) const
+	{
+		word c = 0;
+
+		if (x[0] & 1)
+		{
+			// x + N is even
+			for (size_t i = 0; i < n; i++)
+			{
+				unsigned __int128 s = static_cast<unsigned __int128>(x[i]) + N[i] + c;
+
+				x[i] = static_cast<word>(s);
+				c	 = static_cast<word>(s >> 64);
+			}
+		}
+
+		for (size_t i = 0; i < n; i++)
+		{
+			word next = i + 1 < n ? x[i + 1] : c;
+			x[i]	  = (x[i] >> 1) | (next << 63);
+		}
+	}
+
+	/**
+	 * @brief x^e in Montgomery form, with a fixed window of 4 bits
+	 *
+	 * @param x in Montgomery form
+	 * @param e
+	 * @pre{e >= 0}
+	 */
+	montgomery::words montgomery::pow(const words &x, const dint &e) const
+	{
+		constexpr size_t window = 4;
+
+		// x^0 .. x^15
+		vector<words> table(size_t{1} << window);
+
+		table[0] = r1;
+		table[1] = x;
+
+		for (size_t i = 2; i < table.size(); i++)
+		{
+			mul(table[i - 1], x, table[i]);
+		}
+
+		words r = r1;
+
+		const size_t len = e.bit_length();
+
+		for (size_t i = (len + window - 1) / window; i-- > 0;)
+		{
+			if (r != r1)
+			{
+				for (size_t j = 0; j < window; j++)
+				{
+					mul(r, r, r);
+				}
+			}
+
+			size_t d = 0;
+			for (size_t j = window; j-- > 0;)
+			{
+				d = (d << 1) | (e.test_bit(i * window + j) ? 1 : 0);
+			}
+
+			if (d != 0)
+			{
+				mul(r, table[d], r);
+			}
+		}
+
+		return r;
+	}
+
+	const montgomery::words &montgomery::one() const
+	{
+		return r1;
+	}
+
+	const montgomery::words &montgomery::zero() const
+	{
+		return r0;
+	}
+
+	const dint &montgomery::modulus() const
+	{
+		return mod;
+	}
+
+	/**
+	 * @brief modular exponentiation.
+	 * Odd moduli use Montgomery multiplication, so no division is needed in the loop.
+	 *
+	 * @param b
+	 * @param e a negative exponent uses the inverse of b
+	 * @param m
+	 * @return dint b^e mod |m| in [0, |m|)
+	 * @throw domain_error if m == 0, or if e < 0 and b is not invertible
+	 */
+	dint powmod(const dint &b, const dint &e, const dint &m)
+	{
+		if (is_zero(m))
+		{
+			throw domain_error("division by zero");
+		}
+
+		dint mod{m};
+		mod.negative = false;
+
+		if (mod == dint{1ULL})
+		{
+			return dint{};
+		}
+
+		if (e.negative && !is_zero(e))
+		{
+			dint pe{e};
+			pe.negative = false;
+
+			return powmod(invmod(b, mod), pe, mod);
+		}
+
+		if (mod.data[0] & 1)
+		{
+			montgomery ctx{mod};
+			return ctx.from(ctx.pow(ctx.to(b), e));
+		}
+
+		dint x = b % mod;
+
+		if (x.negative)
+		{
+			dint::subabs(mod, x, x);
+		}
+
+		dint r{1ULL};
+
+		for (size_t i = e.bit_length(); i-- > 0;)
+		{
+			r = (r * r) % mod;
+
+			if (e.test_bit(i))
+			{
+				r = (r * x) % mod;
+			}
+		}
+
+		return r;
+	}
+} // namespace bigint
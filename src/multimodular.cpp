@@ -0,0 +1,271 @@
+#include "multimodular.h"
+#include "parallel.h"
+
+#include <utility>
+
+namespace bigint
+{
+	using word = multimodular::word;
+
+	// Every prime is below this, so the sum of two residues fits in a word
+	constexpr word prime_limit = word{1} << 62;
+
+	/**
+	 * @brief T 2^-64 mod p
+	 *
+	 * @param T
+	 * @param p
+	 * @param pinv -p^-1 mod 2^64
+	 * @pre{T < p 2^64}
+	 */
+	static inline word redc(unsigned __int128 T, word p, word pinv)
+	{
+		// Adding m p makes the lowest word zero, which is then shifted out
+		const word m = static_cast<word>(T) * pinv;
+		const word t = static_cast<word>((T + static_cast<unsigned __int128>(m) * p) >> 64);
+
+		return t >= p ? t - p : t;
+	}
+
+	/**
+	 * @brief a^-1 mod p with the extended Euclidean algorithm
+	 *
+	 * @pre{0 < a < p and gcd(a, p) = 1}
+	 */
+	static word invert(word a, word p)
+	{
+		int64_t r0 = static_cast<int64_t>(p), r1 = static_cast<int64_t>(a);
+		int64_t s0 = 0, s1 = 1;
+
+		while (r1 != 0)
+		{
+			int64_t q = r0 / r1;
+
+			r0 = exchange(r1, r0 - q * r1);
+			s0 = exchange(s1, s0 - q * s1);
+		}
+
+		return static_cast<word>(s0 < 0 ? s0 + static_cast<int64_t>(p) : s0);
+	}
+
+	/**
+	 * @brief Takes the largest primes below 2^62 until their product M is above 2^(bits + 1),
+	 * so every number with |x| < 2^bits has its own residues.
+	 *
+	 * @param bits
+	 */
+	multimodular::multimodular(size_t bits)
+	{
+		const size_t count = (bits + 1) / 61 + 1;
+
+		for (word c = prime_limit - 1; p.size() < count; c -= 2)
+		{
+			if (is_probable_prime(dint{c}))
+			{
+				p.push_back(c);
+			}
+		}
+
+		pinv.resize(count);
+		r2.resize(count);
+		crt.resize(count);
+
+		vector<dint> leaves(count);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			// Newton's iteration for p^-1 mod 2^64, p * p = 1 (mod 8) so every step doubles the 3 correct bits
+			word inv = p[i];
+			for (int j = 0; j < 5; j++)
+			{
+				inv *= 2 - p[i] * inv;
+			}
+			pinv[i] = -inv;
+
+			const word r = static_cast<word>((static_cast<unsigned __int128>(1) << 64) % p[i]);
+			r2[i]		 = static_cast<word>(static_cast<unsigned __int128>(r) * r % p[i]);
+
+			leaves[i] = dint{p[i]};
+		}
+
+		tree = product_tree(leaves);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			// (M / p) mod p in Montgomery form, starting from 2^64 mod p which is 1 in that form
+			word m = redc(r2[i], p[i], pinv[i]);
+
+			for (size_t j = 0; j < count; j++)
+			{
+				if (j != i)
+				{
+					// All primes are within a factor 2 of each other, so the remainder is at most one substraction
+					const word r = p[j] > p[i] ? p[j] - p[i] : p[j];
+
+					m = redc(static_cast<unsigned __int128>(m) * redc(static_cast<unsigned __int128>(r) * r2[i], p[i], pinv[i]), p[i], pinv[i]);
+				}
+			}
+
+			crt[i] = invert(redc(m, p[i], pinv[i]), p[i]);
+		}
+
+		half = modulus();
+		half >>= 1;
+	}
+
+	/**
+	 * @brief The residues of x, every prime on its own by Horner's rule on the machine words of x from the top,
+	 * in Montgomery form so a step is two reductions without a division.
+	 *
+	 * @param x
+	 * @param threads the number of threads to use, 0 for all the hardware has
+	 * @pre{|x| < M / 2}
+	 */
+	multimodular::residues multimodular::to(const dint &x, size_t threads) const
+	{
+		const base *px = x.data.data();
+		const size_t n = x.size();
+
+		residues res(size());
+
+		parallel_for(size(), threads,
+					 [&](size_t i)
+					 {
+						 const word q = p[i], qinv = pinv[i], r = r2[i];
+
+						 word a = 0;
+
+						 for (size_t j = (n - 1) / dint::word_size * dint::word_size;; j -= dint::word_size)
+						 {
+							 const word w = dint::load_word(px + j, min(dint::word_size, n - j));
+
+							 // (a 2^64 + w) 2^64 = a 2^128 + w 2^128
+							 a = redc(static_cast<unsigned __int128>(a) * r, q, qinv) + redc(static_cast<unsigned __int128>(w) * r, q, qinv);
+							 a = a >= q ? a - q : a;
+
+							 if (j == 0)
+							 {
+								 break;
+							 }
+						 }
+
+						 res[i] = x.neg() && a != 0 ? q - a : a;
+					 });
+
+		return res;
+	}
+
+	/**
+	 * @brief The number with the residues, by the Chinese remainder theorem.
+	 * x = sum c_i M / p_i mod M with c_i = x_i (M / p_i)^-1 mod p_i, where the sum is built up the product tree:
+	 * a node is the sum of its children, each multiplied by the product of the primes of the other.
+	 *
+	 * @param a
+	 * @param threads the number of threads to use, 0 for all the hardware has
+	 * @return dint in (-M / 2, M / 2]
+	 */
+	dint multimodular::from(const residues &a, size_t threads) const
+	{
+		vector<dint> v(size());
+
+		// Out of Montgomery form and multiplied by the inverse at once
+		for (size_t i = 0; i < size(); i++)
+		{
+			v[i] = dint{redc(static_cast<unsigned __int128>(a[i]) * crt[i], p[i], pinv[i])};
+		}
+
+		for (size_t k = 0; k + 1 < tree.size(); k++)
+		{
+			const vector<dint> &level = tree[k];
+			vector<dint> next(tree[k + 1].size());
+
+			parallel_for(next.size(), threads,
+						 [&](size_t i)
+						 {
+							 if (2 * i + 1 < level.size())
+							 {
+								 next[i] = v[2 * i] * level[2 * i + 1] + v[2 * i + 1] * level[2 * i];
+							 }
+							 else
+							 {
+								 next[i] = move(v[2 * i]);
+							 }
+						 });
+
+			v = move(next);
+		}
+
+		dint x = v[0] % modulus();
+
+		if (x > half)
+		{
+			x -= modulus();
+		}
+
+		return x;
+	}
+
+	/**
+	 * @brief dest = a + b
+	 *
+	 * @post{dest may be a or b}
+	 */
+	void multimodular::add(const residues &a, const residues &b, residues &dest) const
+	{
+		dest.resize(size());
+
+		for (size_t i = 0; i < size(); i++)
+		{
+			const word s = a[i] + b[i];
+			dest[i]		 = s >= p[i] ? s - p[i] : s;
+		}
+	}
+
+	/**
+	 * @brief dest = a - b
+	 *
+	 * @post{dest may be a or b}
+	 */
+	void multimodular::sub(const residues &a, const residues &b, residues &dest) const
+	{
+		dest.resize(size());
+
+		for (size_t i = 0; i < size(); i++)
+		{
+			dest[i] = a[i] >= b[i] ? a[i] - b[i] : a[i] + p[i] - b[i];
+		}
+	}
+
+	/**
+	 * @brief dest = a b
+	 *
+	 * @post{dest may be a or b}
+	 */
+	void multimodular::mul(const residues &a, const residues &b, residues &dest) const
+	{
+		dest.resize(size());
+
+		for (size_t i = 0; i < size(); i++)
+		{
+			dest[i] = redc(static_cast<unsigned __int128>(a[i]) * b[i], p[i], pinv[i]);
+		}
+	}
+
+	size_t multimodular::size() const
+	{
+		return p.size();
+	}
+
+	const vector<word> &multimodular::primes() const
+	{
+		return p;
+	}
+
+	/**
+	 * @brief M, the product of the primes
+	 */
+	const dint &multimodular::modulus() const
+	{
+		return tree.back()[0];
+	}
+} // namespace bigint
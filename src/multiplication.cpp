@@ -1,6 +1,6 @@
 #include "dint.h"
-
-constexpr size_t cutoff = 12; // Empirically tested
+#include "progress.h"
+#include "tuning.h"
 
 namespace bigint
 {
@@ -49,6 +49,8 @@ namespace bigint
 		size_t sa = a_end - a_begin;
 		size_t sb = b_end - b_begin;
 
+		BIGINT_STAT(counters.basicmult++; counters.basicmult_limbs += sa * sb;)
+
 		base c, t;
 		base lo, hi;
 
@@ -120,6 +122,44 @@ namespace bigint
 		return c;
 	}
 
+	/**
+	 * @brief multiplies the absolute value of a by the machine word w, eight words at a time
+	 *
+	 * @param a
+	 * @param w
+	 * @param dest the result will go into this container, may not be a
+	 * @post{dest is normalized}
+	 */
+	void dint::mul_word(const container &a, uint64_t w, container &dest)
+	{
+		const size_t n = a.size();
+
+		// Room for whole machine words and the last carry
+		dest.resize((n + word_size - 1) / word_size * word_size + word_size);
+
+		uint64_t c = 0;
+		size_t i   = 0;
+
+		for (; i < n; i += word_size)
+		{
+			unsigned __int128 p = static_cast<unsigned __int128>(load_word(a.data() + i, min(word_size, n - i))) * w + c;
+
+			store_word(dest.data() + i, static_cast<uint64_t>(p), word_size);
+			c = static_cast<uint64_t>(p >> 64);
+		}
+
+		store_word(dest.data() + i, c, word_size);
+
+		size_t m = dest.size();
+
+		while (m > 1 && dest[m - 1] == 0)
+		{
+			m--;
+		}
+
+		dest.resize(m);
+	}
+
 	/**
 	 * @brief
 	 *
@@ -152,6 +192,8 @@ namespace bigint
 		// And the notation thing[i] means the i'th word of thing
 		// And the notation a : i means that a is i words long
 
+		BIGINT_STAT(karatsuba_frame frame;)
+
 		bool b_Nil = true;
 		for (auto &&p = container::const_iterator{small_begin}; p != small_end; ++p)
 		{
@@ -174,8 +216,12 @@ namespace bigint
 			return;
 		}
 
-		if (n <= cutoff)
+		if (n <= tuning.mul)
 		{
+			progress::checkpoint(n * n);
+
+			// basicmult accumulates into dest
+			fill(dest_begin, dest_end, base{0});
 			basicmult(big_begin, big_end, small_begin, small_end, dest_begin, dest_end);
 
 			return;
@@ -344,46 +390,69 @@ namespace bigint
 		}
 
 		// Substract z0 and z2 from (a_hi * a_lo) * (b_hi * b_lo) to get z1
-		subiter(static_cast<const_iterator>(dest_q1), static_cast<const_iterator>(dest_end), static_cast<const_iterator>(buff_mid), static_cast<const_iterator>(buff_q3 + 1), static_cast<iterator>(dest_q1), static_cast<iterator>(dest_end), static_cast<iterator*>(nullptr), false);
+		subiter(static_cast<const_iterator>(dest_q1), static_cast<const_iterator>(dest_end), static_cast<const_iterator>(buff_mid), static_cast<const_iterator>(buff_q3 + 1), static_cast<iterator>(dest_q1), static_cast<iterator>(dest_end), false);
 		// z2 << n + z1 << n/2 + z0 -> dest : 2n
 
 		return;
 	}
 
 	/**
-	 * @brief multiplies a and b together and stores the result in dest.
+	 * @brief multiplies the absolute values of a and b together and stores the result in dest, its sign is not changed.
 	 * 
 	 * @param a 
 	 * @param b 
-	 * @param dest 
+	 * @param dest may be a or b
 	 */
-	void mult(const dint &a, const dint &b, dint &dest){
+	void dint::multabs(const dint &a, const dint &b, dint &dest){
 
-		static container buff{};
-		static size_t buff_size = 0;
-		static container::iterator buff_begin = buff.begin();
-		static container::iterator buff_end = buff.end();
+		// Always on the heap, an arena that is current during the first call may be released before the next.
+		// One per thread, so products can be computed on several threads at once.
+		thread_local container buff{limb_allocator<base>{nullptr}};
+		thread_local size_t buff_size = 0;
+		thread_local container::iterator buff_begin = buff.begin();
+		thread_local container::iterator buff_end = buff.end();
 
-		size_t sa = a.data.size();
-		size_t sb = b.data.size();
+		const dint &big = a.data.size() >= b.data.size() ? a : b;
+		const dint &small = a.data.size() >= b.data.size() ? b : a;
 
-		dint &at = const_cast<dint &>(a);
-		dint &bt = const_cast<dint &>(b);
+		size_t sa = big.data.size();
+		size_t sb = small.data.size();
 
-		size_t n;
+		BIGINT_STAT(counters.count(stats::mul, sa);)
 
-		if (sa >= sb)
+		if (sa <= dint::word_size)
 		{
-			n = sa;
-			bt.data.resize(n);
+			// Both fit in a machine word
+			unsigned __int128 p = static_cast<unsigned __int128>(dint::get_word(big.data)) * dint::get_word(small.data);
+
+			dest.set_word(static_cast<uint64_t>(p), static_cast<uint64_t>(p >> 64));
+			return;
 		}
-		else
+
+		if (sb <= dint::word_size)
 		{
-			n = sb;
-			at.data.resize(n);
+			container res;
+			dint::mul_word(big.data, dint::get_word(small.data), res);
+
+			dest.data = move(res);
+			return;
 		}
 
-		dest.data.resize(2 * n);
+		// The result is built separately so dest may be a or b
+		container res(sa + sb, base{0});
+
+		if (sb <= tuning.mul)
+		{
+			progress::checkpoint(sa * sb);
+
+			basicmult(big.data.cbegin(), big.data.cend(), small.data.cbegin(), small.data.cend(), res.begin(), res.end());
+
+			dest.data = move(res);
+			dest.remove_leading_zeros();
+			return;
+		}
+
+		size_t n = sb;
 
 		if (4 * n > buff_size)
 		{
@@ -398,24 +467,52 @@ namespace bigint
 			buff_end = buff_begin + 4 * n;
 		}
 
-		auto a_begin = a.data.cbegin();
-		auto a_end = a.data.cend();
-		auto b_begin = b.data.cbegin();
-		auto b_end = b.data.cend();
-		auto dest_begin = dest.data.begin();
-		auto dest_end = dest.data.end();
+		// Cut the big number in pieces of n words, so karatsuba always gets balanced arguments
+		container piece(n);
+		container prod(2 * n);
+
+		for (size_t i = 0; i < sa; i += n)
+		{
+			size_t len = min(n, sa - i);
+
+			auto piece_begin = big.data.cbegin() + i;
+			auto piece_end = piece_begin + len;
+
+			if (len < n)
+			{
+				// The last piece is padded with zeros
+				fill(copy(piece_begin, piece_end, piece.begin()), piece.end(), base{0});
+
+				piece_begin = piece.cbegin();
+				piece_end = piece.cend();
+			}
 
-		dint::karatsuba(a_begin, a_end, b_begin, b_end, dest_begin, dest_end, buff_begin, buff_end, n);
+			dint::karatsuba(piece_begin, piece_end, small.data.cbegin(), small.data.cend(), prod.begin(), prod.end(), buff_begin, buff_end, n);
 
-		if(sa >= sb){
-			bt.remove_leading_zeros();
-		}else{
-			at.remove_leading_zeros();
+			// piece * small fits in len + n words
+			dint::additer(static_cast<const_iterator>(res.begin() + i), static_cast<const_iterator>(res.end()), prod.cbegin(), prod.cbegin() + len + n, res.begin() + i, res.end(), false);
 		}
 
+		dest.data = move(res);
 		dest.remove_leading_zeros();
 	}
 
+	/**
+	 * @brief multiplies a and b together and stores the result in dest.
+	 *
+	 * @param a
+	 * @param b
+	 * @param dest may be a or b
+	 */
+	void mult(const dint &a, const dint &b, dint &dest)
+	{
+		const bool negative = a.negative != b.negative;
+
+		dint::multabs(a, b, dest);
+
+		dest.negative = negative && !(dest.size() == 1 && dest.data[0] == 0);
+	}
+
 	dint operator*(const dint &a, const dint &b)
 	{
 		dint res;
@@ -452,5 +549,267 @@ namespace bigint
 			data.push_back(c);
 		}
 		remove_leading_zeros();
+
+		if (size() == 1 && data[0] == 0)
+		{
+			negative = false;
+		}
+	}
+
+	/**
+	 * @brief a to the power e, by repeated squaring
+	 *
+	 * @param a
+	 * @param e
+	 * @return dint
+	 */
+	dint pow(const dint &a, unsigned long long e)
+	{
+		dint res{1ULL};
+		dint x{a};
+
+		for (; e != 0; e >>= 1)
+		{
+			if (e & 1)
+			{
+				res = res * x;
+			}
+
+			if (e > 1)
+			{
+				x = x * x;
+			}
+		}
+
+		return res;
+	}
+
+	// Short products split at about this fraction of n, close to the best split for Karatsuba found by Mulders
+	constexpr size_t mulders_num = 7;
+	constexpr size_t mulders_den = 10;
+
+	/**
+	 * @brief below this many words the short products are done with the schoolbook method,
+	 * never below 16 so the error bound of mulhigh holds
+	 */
+	static size_t short_threshold()
+	{
+		return max<size_t>(2 * tuning.mul, 16);
+	}
+
+	/**
+	 * @brief where a short product of n words is split, rounded up to a multiple of 16 words
+	 * because karatsuba is a lot slower on sizes with odd halves
+	 *
+	 * @post{n / 2 <= k < n}
+	 */
+	static size_t mulders_split(size_t n)
+	{
+		const size_t k = (n * mulders_num + mulders_den - 1) / mulders_den;
+
+		return min((k + 15) / 16 * 16, n - 1);
+	}
+
+	/**
+	 * @brief the absolute value of the words [from, to) of a
+	 */
+	dint dint::slice(const dint &a, size_t from, size_t to)
+	{
+		to = min(to, a.size());
+
+		if (from >= to)
+		{
+			return dint{};
+		}
+
+		return dint{container(a.data.begin() + from, a.data.begin() + to)};
+	}
+
+	/**
+	 * @brief |a b| mod B^n, with B = 2^bits_per_word. Mulders' short product: the low k words of a and b are
+	 * multiplied in full and the two cross products only down to n - k words, each a short product again.
+	 *
+	 * @param a
+	 * @param b
+	 * @param n
+	 * @param dest
+	 */
+	void dint::mullowabs(const dint &a, const dint &b, size_t n, dint &dest)
+	{
+		const size_t sa = min(a.size(), n);
+		const size_t sb = min(b.size(), n);
+
+		if (n <= short_threshold())
+		{
+			container res(n, base{0});
+
+			for (size_t i = 0; i < sa; i++)
+			{
+				const size_t m = min(sb, n - i);
+
+				unsigned int c = 0;
+
+				for (size_t j = 0; j < m; j++)
+				{
+					unsigned int t = static_cast<unsigned int>(a.data[i]) * b.data[j] + res[i + j] + c;
+
+					res[i + j] = static_cast<base>(t);
+					c		   = t >> bits_per_word;
+				}
+
+				// Words above this row are still zero, the carry out of a truncated row is dropped
+				if (i + m < n)
+				{
+					res[i + m] = static_cast<base>(c);
+				}
+			}
+
+			dest = dint{move(res)};
+			return;
+		}
+
+		const size_t k = mulders_split(n);
+
+		dint full, cross1, cross2;
+
+		multabs(slice(a, 0, k), slice(b, 0, k), full);
+		mullowabs(slice(a, 0, n - k), slice(b, k, n), n - k, cross1);
+		mullowabs(slice(a, k, n), slice(b, 0, n - k), n - k, cross2);
+
+		cross1 += cross2;
+		cross1.shiftwordsleft(k);
+		full += cross1;
+
+		dest = slice(full, 0, n);
+	}
+
+	/**
+	 * @brief Approximately floor(|a b| / B^n) for a and b of at most n words, with B = 2^bits_per_word.
+	 * Mulders' short product: the high k words of a and b are multiplied in full, the cross products
+	 * of a high and a low part are short products again, and the product of the low parts is left out.
+	 * Every left out part and every truncation loses less than 1, which keeps the error below n.
+	 *
+	 * @param a
+	 * @param b
+	 * @param n
+	 * @param dest
+	 * @pre{a.size() <= n and b.size() <= n}
+	 * @post{floor(|a b| / B^n) - n < dest <= floor(|a b| / B^n)}
+	 */
+	void dint::mulhighabs(const dint &a, const dint &b, size_t n, dint &dest)
+	{
+		const size_t sa = a.size();
+		const size_t sb = b.size();
+
+		if (n <= short_threshold())
+		{
+			// Only the products of words i and j with i + j >= n - 1, the others are too small to reach word n
+			container res(2 * n + 1, base{0});
+
+			for (size_t i = 0; i < sa; i++)
+			{
+				const size_t first = i + 1 >= n ? 0 : n - 1 - i;
+
+				if (first >= sb)
+				{
+					continue;
+				}
+
+				unsigned int c = 0;
+
+				for (size_t j = first; j < sb; j++)
+				{
+					unsigned int t = static_cast<unsigned int>(a.data[i]) * b.data[j] + res[i + j] + c;
+
+					res[i + j] = static_cast<base>(t);
+					c		   = t >> bits_per_word;
+				}
+
+				res[i + sb] = static_cast<base>(c);
+			}
+
+			dest = dint{container(res.begin() + n, res.end())};
+			return;
+		}
+
+		// k >= n / 2, so the product of the low parts is below B^n
+		const size_t k = mulders_split(n);
+
+		dint full, cross1, cross2;
+
+		multabs(slice(a, n - k, n), slice(b, n - k, n), full);
+		mulhighabs(slice(a, k, n), slice(b, 0, n - k), n - k, cross1);
+		mulhighabs(slice(b, k, n), slice(a, 0, n - k), n - k, cross2);
+
+		full.shiftwordsright(2 * k - n);
+		full += cross1;
+		full += cross2;
+
+		dest = move(full);
+	}
+
+	/**
+	 * @brief the low n words of a b, exactly. About 0.8 of the cost of the full product for large n.
+	 *
+	 * @param a
+	 * @param b
+	 * @param n
+	 * @return dint |a b| mod 2^(bits_per_word n) with the sign of a b
+	 */
+	dint mullow(const dint &a, const dint &b, size_t n)
+	{
+		dint r;
+		dint::mullowabs(a, b, n, r);
+
+		r.negative = (a.negative != b.negative) && !(r.size() == 1 && r.data[0] == 0);
+		return r;
+	}
+
+	/**
+	 * @brief the high n words of the 2n word product of a and b, up to an error below n.
+	 * About 0.8 of the cost of the full product for large n.
+	 *
+	 * @param a
+	 * @param b
+	 * @param n
+	 * @return dint h with floor(|a b| / 2^(bits_per_word n)) - n < |h| <= floor(|a b| / 2^(bits_per_word n)),
+	 * with the sign of a b
+	 * @pre{a and b have at most n words}
+	 */
+	dint mulhigh(const dint &a, const dint &b, size_t n)
+	{
+		dint r;
+		dint::mulhighabs(a, b, n, r);
+
+		r.negative = (a.negative != b.negative) && !(r.size() == 1 && r.data[0] == 0);
+		return r;
+	}
+
+	/**
+	 * @brief The middle n words, n to 2n, of the product of a of 2n words and b of n words, up to an error below n
+	 * in those words, as needed by Newton iterations where the low words are garbage and the high words are known.
+	 * The high half of a only reaches them through the low words of its product and the low half only through
+	 * the high words of its product, so it is a mullow and a mulhigh, about 1.6 times a product of n words
+	 * where the full product costs 2.
+	 *
+	 * @param a
+	 * @param b
+	 * @param n
+	 * @return dint m with (x - m) mod 2^(bits_per_word n) < n for the middle words x of |a b|, with the sign of a b
+	 * @pre{a has at most 2n words and b at most n}
+	 */
+	dint middle_product(const dint &a, const dint &b, size_t n)
+	{
+		dint low, high;
+
+		dint::mulhighabs(dint::slice(a, 0, n), b, n, low);
+		dint::mullowabs(dint::slice(a, n, 2 * n), b, n, high);
+
+		high += low;
+
+		dint r = dint::slice(high, 0, n);
+
+		r.negative = (a.negative != b.negative) && !(r.size() == 1 && r.data[0] == 0);
+		return r;
 	}
-}
\ No newline at end of file
+}
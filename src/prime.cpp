@@ -0,0 +1,514 @@
+#include "montgomery.h"
+#include "philox.h"
+
+// Trial division and sieving use the primes below this bound
+constexpr unsigned long long trial_bound = 4096;
+
+// The sieve of next_prime covers at least this many odd candidates at a time
+constexpr size_t sieve_window = 256;
+
+namespace bigint
+{
+	using words = montgomery::words;
+
+	/**
+	 * @brief The odd primes below the trial bound, in groups whose product fits in a machine word.
+	 * One remainder of the product gives the remainders of all the primes of the group.
+	 */
+	struct prime_group
+	{
+		unsigned long long product;
+		vector<unsigned long long> primes;
+	};
+
+	static const vector<prime_group> &prime_groups()
+	{
+		static const vector<prime_group> groups = []
+		{
+			vector<bool> composite(trial_bound, false);
+			vector<prime_group> r;
+
+			prime_group g{1, {}};
+
+			for (unsigned long long p = 3; p < trial_bound; p += 2)
+			{
+				if (composite[p])
+				{
+					continue;
+				}
+
+				for (unsigned long long q = p * p; q < trial_bound; q += 2 * p)
+				{
+					composite[q] = true;
+				}
+
+				if (g.product > numeric_limits<unsigned long long>::max() / p)
+				{
+					r.push_back(move(g));
+					g = prime_group{1, {}};
+				}
+
+				g.product *= p;
+				g.primes.push_back(p);
+			}
+
+			r.push_back(move(g));
+
+			return r;
+		}();
+
+		return groups;
+	}
+
+	static unsigned long long mulmod_word(unsigned long long a, unsigned long long b, unsigned long long m)
+	{
+		return static_cast<unsigned long long>(static_cast<unsigned __int128>(a) * b % m);
+	}
+
+	/**
+	 * @brief deterministic primality of a machine word, Miller-Rabin with the first 12 primes as bases is exact for every
+	 * n < 2^64 (the bound for these bases is about 3.18 * 10^23)
+	 */
+	static bool is_prime_word(unsigned long long n)
+	{
+		static const unsigned long long bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+
+		if (n < 2)
+		{
+			return false;
+		}
+
+		for (unsigned long long p : bases)
+		{
+			if (n % p == 0)
+			{
+				return n == p;
+			}
+		}
+
+		unsigned long long d = n - 1;
+		int s				 = countr_zero(d);
+		d >>= s;
+
+		for (unsigned long long a : bases)
+		{
+			unsigned long long x = 1;
+			unsigned long long y = a;
+
+			for (unsigned long long e = d; e != 0; e >>= 1)
+			{
+				if (e & 1)
+				{
+					x = mulmod_word(x, y, n);
+				}
+				y = mulmod_word(y, y, n);
+			}
+
+			if (x == 1 || x == n - 1)
+			{
+				continue;
+			}
+
+			bool witness = true;
+
+			for (int i = 1; i < s && witness; i++)
+			{
+				x		= mulmod_word(x, x, n);
+				witness = x != n - 1;
+			}
+
+			if (witness)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief whether n has an odd prime factor below the trial bound
+	 *
+	 * @pre{n > trial_bound}
+	 */
+	static bool has_small_factor(const dint &n)
+	{
+		for (const prime_group &g : prime_groups())
+		{
+			unsigned long long r = mod_word(n, g.product);
+
+			for (unsigned long long p : g.primes)
+			{
+				if (r % p == 0)
+				{
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief Jacobi symbol (a / n) of machine words
+	 *
+	 * @pre{n is odd}
+	 */
+	static int jacobi_word(unsigned long long a, unsigned long long n)
+	{
+		int r = 1;
+
+		a %= n;
+
+		while (a != 0)
+		{
+			int z = countr_zero(a);
+			a >>= z;
+
+			// (2 / n) = -1 if n = 3, 5 (mod 8)
+			if ((z & 1) && (n % 8 == 3 || n % 8 == 5))
+			{
+				r = -r;
+			}
+
+			// Quadratic reciprocity, the sign flips if both are 3 (mod 4)
+			if (a % 4 == 3 && n % 4 == 3)
+			{
+				r = -r;
+			}
+
+			swap(a, n);
+			a %= n;
+		}
+
+		return n == 1 ? r : 0;
+	}
+
+	/**
+	 * @brief Jacobi symbol (d / n) for a small odd d
+	 *
+	 * @pre{n is odd}
+	 */
+	static int jacobi(long long d, const dint &n)
+	{
+		const unsigned long long n4 = mod_word(n, 4);
+		const unsigned long long a	= static_cast<unsigned long long>(d < 0 ? -d : d);
+
+		int r = 1;
+
+		// (-1 / n) = -1 if n = 3 (mod 4)
+		if (d < 0 && n4 == 3)
+		{
+			r = -r;
+		}
+
+		if (a % 4 == 3 && n4 == 3)
+		{
+			r = -r;
+		}
+
+		return r * jacobi_word(mod_word(n, a), a);
+	}
+
+	/**
+	 * @brief strong probable prime test to base a
+	 *
+	 * @param m Montgomery context of n
+	 * @param d odd part of n - 1
+	 * @param s n - 1 = d 2^s
+	 * @param a the base in Montgomery form
+	 */
+	static bool miller_rabin(const montgomery &m, const dint &d, size_t s, const words &a)
+	{
+		words minus_one;
+		m.sub(m.zero(), m.one(), minus_one);
+
+		words x = m.pow(a, d);
+
+		if (x == m.one() || x == minus_one)
+		{
+			return true;
+		}
+
+		for (size_t i = 1; i < s; i++)
+		{
+			m.mul(x, x, x);
+
+			if (x == minus_one)
+			{
+				return true;
+			}
+			if (x == m.one())
+			{
+				return false;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief strong Lucas probable prime test with Selfridge's parameters:
+	 * the first D of 5, -7, 9, -11, ... with (D / n) = -1, P = 1 and Q = (1 - D) / 4.
+	 *
+	 * @param m Montgomery context of n
+	 * @pre{n is odd, not a perfect square and has no factors below the trial bound}
+	 */
+	static bool strong_lucas(const montgomery &m)
+	{
+		const dint &n = m.modulus();
+
+		long long D = 5;
+
+		while (jacobi(D, n) != -1)
+		{
+			D = D > 0 ? -(D + 2) : -D + 2;
+		}
+
+		auto signed_dint = [](long long x)
+		{
+			dint r{static_cast<unsigned long long>(x < 0 ? -x : x)};
+			return x < 0 ? -r : r;
+		};
+
+		const words d = m.to(signed_dint(D));
+		const words q = m.to(signed_dint((1 - D) / 4));
+
+		// n + 1 = k 2^s with k odd
+		dint k = n;
+		++k;
+
+		const size_t s = k.countr_zero();
+		k >>= static_cast<unsigned int>(s);
+
+		words u = m.one();
+		words v = m.one();
+		words qk = q;
+		words t;
+
+		for (size_t i = k.bit_length() - 1; i-- > 0;)
+		{
+			// U_2k = U_k V_k, V_2k = V_k^2 - 2 Q^k
+			m.mul(u, v, u);
+			m.mul(v, v, v);
+			m.add(qk, qk, t);
+			m.sub(v, t, v);
+			m.mul(qk, qk, qk);
+
+			if (k.test_bit(i))
+			{
+				// U_k+1 = (P U_k + V_k) / 2, V_k+1 = (D U_k + P V_k) / 2
+				m.mul(d, u, t);
+				m.add(u, v, u);
+				m.half(u);
+				m.add(t, v, v);
+				m.half(v);
+				m.mul(qk, q, qk);
+			}
+		}
+
+		if (u == m.zero() || v == m.zero())
+		{
+			return true;
+		}
+
+		for (size_t i = 1; i < s; i++)
+		{
+			m.mul(v, v, v);
+			m.add(qk, qk, t);
+			m.sub(v, t, v);
+
+			if (v == m.zero())
+			{
+				return true;
+			}
+
+			m.mul(qk, qk, qk);
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief Baillie-PSW test followed by Miller-Rabin with random bases
+	 *
+	 * @pre{n has no factors below the trial bound and n > 2^64}
+	 */
+	static bool probable_prime(const dint &n, int rounds)
+	{
+		montgomery m{n};
+
+		// n - 1 for odd n
+		dint d{n};
+		d.clear_bit(0);
+
+		const size_t s = d.countr_zero();
+		d >>= static_cast<unsigned int>(s);
+
+		if (!miller_rabin(m, d, s, m.to(dint{2ULL})))
+		{
+			return false;
+		}
+
+		// The Lucas test needs a D with (D / n) = -1, which does not exist for squares
+		if (is_perfect_square(n) || !strong_lucas(m))
+		{
+			return false;
+		}
+
+		// The bases are random but reproducible for the same n
+		philox gen{static_cast<unsigned long long>(n)};
+
+		const dint range = n >> 1;
+
+		for (int i = 0; i < rounds; i++)
+		{
+			// a in [2, n / 2 + 1]
+			dint a;
+			a.random_below(range, gen);
+			a += base{2};
+
+			if (!miller_rabin(m, d, s, m.to(a)))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief Whether n is probably prime.
+	 * Trial division by the small primes, using one remainder per machine word of primes, rejects most composites.
+	 * The rest go through the Baillie-PSW test, a strong Miller-Rabin test to base 2 and a strong Lucas test,
+	 * which has no known counterexamples. Numbers below 2^64 are decided exactly.
+	 *
+	 * @param n the sign is ignored
+	 * @param rounds additional Miller-Rabin rounds with random bases, each lets a composite through with probability at most 1/4
+	 * @return bool
+	 */
+	bool is_probable_prime(const dint &n, int rounds)
+	{
+		dint a{n};
+		a.negative = false;
+
+		if (a.bit_length() <= 64)
+		{
+			return is_prime_word(static_cast<unsigned long long>(a));
+		}
+
+		if (!(a.data[0] & 1) || has_small_factor(a))
+		{
+			return false;
+		}
+
+		return probable_prime(a, rounds);
+	}
+
+	/**
+	 * @brief The smallest probable prime bigger than n.
+	 * Windows of odd candidates are sieved with the small primes, only the survivors are tested.
+	 *
+	 * @param n
+	 * @return dint
+	 */
+	dint next_prime(const dint &n)
+	{
+		if (n.negative || n.bit_length() <= 1)
+		{
+			return dint{2ULL};
+		}
+
+		dint start{n};
+		++start;
+
+		if (!(start.data[0] & 1))
+		{
+			++start;
+		}
+
+		const size_t window = max(sieve_window, start.bit_length());
+
+		vector<bool> composite(window);
+
+		while (true)
+		{
+			fill(composite.begin(), composite.end(), false);
+
+			const bool small = start.bit_length() <= 64;
+			const auto first = small ? static_cast<unsigned long long>(start) : 0;
+
+			for (const prime_group &g : prime_groups())
+			{
+				unsigned long long r = mod_word(start, g.product);
+
+				for (unsigned long long p : g.primes)
+				{
+					// start + 2 i = 0 (mod p) for i = -r / 2 (mod p)
+					unsigned long long i = (p - r % p) % p * ((p + 1) / 2) % p;
+
+					// p itself is not composite
+					if (small && first + 2 * i == p)
+					{
+						i += p;
+					}
+
+					for (; i < window; i += p)
+					{
+						composite[i] = true;
+					}
+				}
+			}
+
+			for (size_t i = 0; i < window; i++)
+			{
+				if (composite[i])
+				{
+					continue;
+				}
+
+				dint c = start + dint{2ULL * i};
+
+				if (c.bit_length() <= 64 ? is_prime_word(static_cast<unsigned long long>(c)) : probable_prime(c, 0))
+				{
+					return c;
+				}
+			}
+
+			start += dint{2ULL * window};
+		}
+	}
+
+	/**
+	 * @brief A random probable prime of exactly the given number of bits,
+	 * the first prime at or after a uniformly random odd number of that size.
+	 *
+	 * @param bits
+	 * @param gen
+	 * @return dint
+	 * @throw domain_error if bits < 2
+	 */
+	dint random_prime(size_t bits, std::mt19937 &gen)
+	{
+		if (bits < 2)
+		{
+			throw domain_error("no primes with less than 2 bits");
+		}
+
+		while (true)
+		{
+			dint x;
+			x.random_exact_bits(bits, gen);
+			x.set_bit(0);
+
+			// The first prime >= x
+			dint::subabs(x, dint{1ULL}, x);
+			dint p = next_prime(x);
+
+			if (p.bit_length() == bits)
+			{
+				return p;
+			}
+		}
+	}
+} // namespace bigint
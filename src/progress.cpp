@@ -0,0 +1,52 @@
+#include "progress.h"
+
+namespace bigint
+{
+	thread_local progress *progress::current = nullptr;
+
+	/**
+	 * @param token checked at every report
+	 * @param callback may be empty
+	 * @param total the estimated number of word products
+	 * @param step the fraction of the total between two calls of the callback
+	 */
+	progress::progress(cancellation_token token, function<void(double)> callback, uint64_t total, double step)
+		: previous{current}, token{move(token)}, callback{move(callback)}, total{max<uint64_t>(total, 1)},
+		  step{max<uint64_t>(static_cast<uint64_t>(step * static_cast<double>(this->total)), 1)}
+	{
+		current = this;
+	}
+
+	progress::~progress()
+	{
+		current = previous;
+	}
+
+	/**
+	 * @brief counts words products done
+	 * @throw operation_cancelled when the token is cancelled
+	 */
+	void progress::work(uint64_t words)
+	{
+		if (token.cancelled())
+		{
+			throw operation_cancelled{};
+		}
+
+		done += words;
+
+		if (callback && done >= next && done < total)
+		{
+			callback(static_cast<double>(done) / static_cast<double>(total));
+			next = done + step;
+		}
+	}
+
+	void progress::finish()
+	{
+		if (callback)
+		{
+			callback(1.0);
+		}
+	}
+} // namespace bigint
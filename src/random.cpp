@@ -0,0 +1,234 @@
+#include "dint.h"
+#include "philox.h"
+
+namespace bigint
+{
+	/**
+	 * @param seed the key
+	 * @param stream different streams of the same seed do not overlap
+	 */
+	philox::philox(uint64_t seed, uint64_t stream)
+		: key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)},
+		  counter{0, 0, static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)}, buffer{}, index{2}
+	{
+	}
+
+	/**
+	 * @brief the 10 rounds of Philox4x32 on a single counter
+	 */
+	array<uint32_t, 4> philox::block(const array<uint32_t, 4> &c, const array<uint32_t, 2> &k)
+	{
+		constexpr uint64_t m0 = 0xD2511F53;
+		constexpr uint64_t m1 = 0xCD9E8D57;
+		constexpr uint32_t w0 = 0x9E3779B9;
+		constexpr uint32_t w1 = 0xBB67AE85;
+
+		array<uint32_t, 4> x = c;
+		array<uint32_t, 2> y = k;
+
+		for (int round = 0; round < 10; round++)
+		{
+			uint64_t p0 = m0 * x[0];
+			uint64_t p1 = m1 * x[2];
+
+			x = {static_cast<uint32_t>(p1 >> 32) ^ x[1] ^ y[0], static_cast<uint32_t>(p1),
+				 static_cast<uint32_t>(p0 >> 32) ^ x[3] ^ y[1], static_cast<uint32_t>(p0)};
+
+			y[0] += w0;
+			y[1] += w1;
+		}
+
+		return x;
+	}
+
+	void philox::next_block()
+	{
+		buffer = block(counter, key);
+		index  = 0;
+
+		if (++counter[0] == 0)
+		{
+			++counter[1];
+		}
+	}
+
+	philox::result_type philox::operator()()
+	{
+		if (index == 2)
+		{
+			next_block();
+		}
+
+		result_type r = (static_cast<result_type>(buffer[2 * index + 1]) << 32) | buffer[2 * index];
+		index++;
+
+		return r;
+	}
+
+	/**
+	 * @brief skips n outputs in constant time
+	 */
+	void philox::discard(unsigned long long n)
+	{
+		const unsigned int left = 2 - index;
+
+		if (n < left)
+		{
+			index += static_cast<unsigned int>(n);
+			return;
+		}
+
+		n -= left;
+
+		// Skip whole blocks, an odd output left over is taken from the block after
+		uint64_t c = (static_cast<uint64_t>(counter[1]) << 32) | counter[0];
+		c += n / 2;
+
+		counter[0] = static_cast<uint32_t>(c);
+		counter[1] = static_cast<uint32_t>(c >> 32);
+
+		index = 2;
+
+		if (n % 2 == 1)
+		{
+			next_block();
+			index = 1;
+		}
+	}
+
+	/**
+	 * @brief 64 uniform bits from a generator
+	 */
+	template <class generator>
+	static uint64_t next_word(generator &gen)
+	{
+		if constexpr (generator::min() == 0 && generator::max() == numeric_limits<uint64_t>::max())
+		{
+			return gen();
+		}
+		else if constexpr (generator::min() == 0 && generator::max() == numeric_limits<uint32_t>::max())
+		{
+			uint64_t low = gen();
+			return (static_cast<uint64_t>(gen()) << 32) | low;
+		}
+		else
+		{
+			std::uniform_int_distribution<uint64_t> distr;
+			return distr(gen);
+		}
+	}
+
+	/**
+	 * @brief uniformly random in [0, 2^bits), whole words are cut from 64 bit outputs
+	 *
+	 * @param bits
+	 * @param gen
+	 * @post{bit_length() <= bits}
+	 */
+	template <class generator>
+	void dint::random_bits(size_t bits, generator &gen)
+	{
+		constexpr size_t per_output = sizeof(uint64_t) / sizeof(base);
+
+		const size_t len = (bits + bits_per_word - 1) / bits_per_word;
+
+		data.resize(max(len, size_t{1}));
+		data[0]	 = 0;
+		negative = false;
+
+		for (size_t i = 0; i < len; i += per_output)
+		{
+			uint64_t x = next_word(gen);
+
+			if constexpr (std::endian::native == std::endian::little)
+			{
+				memcpy(&data[i], &x, min(len - i, per_output) * sizeof(base));
+			}
+			else
+			{
+				for (size_t j = i; j < min(len, i + per_output); j++, x >>= bits_per_word)
+				{
+					data[j] = static_cast<base>(x);
+				}
+			}
+		}
+
+		if (bits % bits_per_word != 0)
+		{
+			data.back() &= static_cast<base>((1U << (bits % bits_per_word)) - 1);
+		}
+
+		remove_leading_zeros();
+	}
+
+	/**
+	 * @brief uniformly random with exactly the given number of bits, in [2^(bits - 1), 2^bits)
+	 *
+	 * @param bits
+	 * @param gen
+	 * @pre{bits > 0}
+	 */
+	template <class generator>
+	void dint::random_exact_bits(size_t bits, generator &gen)
+	{
+		random_bits(bits - 1, gen);
+		set_bit(bits - 1);
+	}
+
+	/**
+	 * @brief uniformly random in [0, bound), by rejecting the draws of bound.bit_length() bits that are too large.
+	 * Less than two draws are needed on average.
+	 *
+	 * @param bound
+	 * @param gen
+	 * @throw domain_error if bound <= 0
+	 */
+	template <class generator>
+	void dint::random_below(const dint &bound, generator &gen)
+	{
+		if (bound.negative || (bound.size() == 1 && bound.data[0] == 0))
+		{
+			throw domain_error("empty range");
+		}
+
+		// The bound might be this dint
+		const dint b{bound};
+
+		do
+		{
+			random_bits(b.bit_length(), gen);
+		} while (!abslst(*this, b));
+	}
+
+	/**
+	 * @brief fills every dint of the range with random_bits, reusing their storage
+	 *
+	 * @param dest
+	 * @param bits
+	 * @param gen
+	 */
+	template <class generator>
+	void dint::random_bits(span<dint> dest, size_t bits, generator &gen)
+	{
+		for (dint &x : dest)
+		{
+			x.random_bits(bits, gen);
+		}
+	}
+
+	template void dint::random_bits<std::mt19937>(size_t, std::mt19937 &);
+	template void dint::random_bits<std::mt19937_64>(size_t, std::mt19937_64 &);
+	template void dint::random_bits<philox>(size_t, philox &);
+
+	template void dint::random_exact_bits<std::mt19937>(size_t, std::mt19937 &);
+	template void dint::random_exact_bits<std::mt19937_64>(size_t, std::mt19937_64 &);
+	template void dint::random_exact_bits<philox>(size_t, philox &);
+
+	template void dint::random_below<std::mt19937>(const dint &, std::mt19937 &);
+	template void dint::random_below<std::mt19937_64>(const dint &, std::mt19937_64 &);
+	template void dint::random_below<philox>(const dint &, philox &);
+
+	template void dint::random_bits<std::mt19937>(span<dint>, size_t, std::mt19937 &);
+	template void dint::random_bits<std::mt19937_64>(span<dint>, size_t, std::mt19937_64 &);
+	template void dint::random_bits<philox>(span<dint>, size_t, philox &);
+} // namespace bigint
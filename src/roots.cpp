@@ -0,0 +1,411 @@
+#include "dint.h"
+
+namespace bigint
+{
+	static bool is_zero(const dint &a)
+	{
+		return a.size() == 1 && a.front() == 0;
+	}
+
+	/**
+	 * @brief floor(x^(1/k)) for machine words
+	 */
+	static unsigned long long iroot_word(unsigned long long x, unsigned long long k)
+	{
+		if (x < 2 || k == 1)
+		{
+			return x;
+		}
+
+		// y^k <= x without overflowing
+		auto fits = [&](unsigned long long y)
+		{
+			unsigned __int128 p = 1;
+			for (unsigned long long i = 0; i < k; i++)
+			{
+				p *= y;
+				if (p > x)
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+
+		auto y = static_cast<unsigned long long>(powl(static_cast<long double>(x), 1.0L / k));
+
+		while (y > 0 && !fits(y))
+		{
+			y--;
+		}
+		while (fits(y + 1))
+		{
+			y++;
+		}
+
+		return y;
+	}
+
+	static unsigned long long powmod_word(unsigned long long a, unsigned long long e, unsigned long long m)
+	{
+		unsigned __int128 r = 1;
+		unsigned __int128 x = a % m;
+
+		for (; e != 0; e >>= 1)
+		{
+			if (e & 1)
+			{
+				r = (r * x) % m;
+			}
+			x = (x * x) % m;
+		}
+
+		return static_cast<unsigned long long>(r);
+	}
+
+	static bool is_prime_word(unsigned long long q)
+	{
+		if (q < 2)
+		{
+			return false;
+		}
+
+		for (unsigned long long d = 2; d * d <= q; d++)
+		{
+			if (q % d == 0)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief squares modulo m
+	 */
+	static vector<bool> square_residues(unsigned int m)
+	{
+		vector<bool> r(m, false);
+
+		for (unsigned int i = 0; i < m; i++)
+		{
+			r[(i * i) % m] = true;
+		}
+
+		return r;
+	}
+
+	/**
+	 * @brief integer square root and remainder (Zimmermann's Karatsuba square root).
+	 * The square root of the top half gives the top half of the root, the bottom half follows from one division,
+	 * so the cost is a constant times a division of half the size.
+	 *
+	 * @param n
+	 * @param s the root will go into this dint
+	 * @param r the remainder will go into this dint
+	 * @post{s * s + r == n}
+	 * @post{n < (s + 1) * (s + 1)}
+	 */
+	void sqrtrem(const dint &n, dint &s, dint &r)
+	{
+		if (n.negative && !is_zero(n))
+		{
+			throw domain_error("square root of a negative number");
+		}
+
+		const size_t len = n.bit_length();
+
+		if (len <= 64)
+		{
+			auto x = static_cast<unsigned long long>(n);
+			auto y = iroot_word(x, 2);
+
+			s = dint{y};
+			r = dint{x - y * y};
+			return;
+		}
+
+		// The low k bits of x
+		auto low = [](const dint &x, size_t k)
+		{
+			container d(x.data.begin(), x.data.begin() + min(x.size(), k / bits_per_word + 1));
+
+			if (k / bits_per_word < d.size())
+			{
+				d[k / bits_per_word] &= (base{1} << (k % bits_per_word)) - 1;
+			}
+
+			return dint{move(d)};
+		};
+
+		// n = a2 2^(2l) + a1 2^l + a0, where a2 has at least 2l + 1 bits
+		const size_t l = (len - 1) / 4;
+
+		dint a0 = low(n, l);
+		dint a1 = low(n >> l, l);
+		dint a2 = n >> (2 * l);
+
+		dint s2, r2;
+		sqrtrem(a2, s2, r2);
+
+		dint q, u;
+		divmod((r2 << l) | a1, s2 << 1, q, u);
+
+		dint root = (s2 << l) + q;
+		dint rem  = (u << l) | a0;
+		dint q2	  = q * q;
+
+		if (!dint::abslst(rem, q2))
+		{
+			dint::subabs(rem, q2, rem);
+		}
+		else
+		{
+			// The root is one too big, r + 2s - 1 is the remainder of s - 1
+			rem = rem + (root << 1);
+			q2 += base{1};
+			dint::subabs(rem, q2, rem);
+			dint::subabs(root, dint{1ULL}, root);
+		}
+
+		s = move(root);
+		r = move(rem);
+	}
+
+	/**
+	 * @brief integer square root
+	 *
+	 * @param n
+	 * @return dint floor(sqrt(n))
+	 * @throw domain_error if n < 0
+	 */
+	dint isqrt(const dint &n)
+	{
+		dint s, r;
+		sqrtrem(n, s, r);
+		return s;
+	}
+
+	/**
+	 * @brief integer k-th root, truncated towards zero.
+	 * The root of the top half of the bits is used as a starting point for Newton's iteration,
+	 * which then only needs one or two steps since it doubles the number of correct bits each step.
+	 *
+	 * @param n
+	 * @param k
+	 * @return dint
+	 * @throw domain_error if k == 0 or if k is even and n < 0
+	 */
+	dint iroot(const dint &n, unsigned long long k)
+	{
+		if (k == 0)
+		{
+			throw domain_error("zeroth root");
+		}
+
+		if (n.negative && !is_zero(n))
+		{
+			if (k % 2 == 0)
+			{
+				throw domain_error("even root of a negative number");
+			}
+
+			return -iroot(-n, k);
+		}
+
+		const size_t len = n.bit_length();
+
+		if (len <= 64)
+		{
+			return dint{iroot_word(static_cast<unsigned long long>(n), k)};
+		}
+
+		if (k >= len)
+		{
+			return dint{1ULL};
+		}
+
+		// Start from above, then Newton's iteration decreases monotonically towards the root
+		const size_t t = len / (2 * k);
+
+		dint x;
+
+		if (t == 0)
+		{
+			x = dint{1ULL} << static_cast<unsigned int>(len / k + 1);
+		}
+		else
+		{
+			x = iroot(n >> static_cast<unsigned int>(k * t), k);
+			x += base{1};
+			x <<= static_cast<unsigned int>(t);
+		}
+
+		const dint km1{k - 1};
+		const dint kd{k};
+
+		while (true)
+		{
+			dint y = (km1 * x + n / pow(x, k - 1)) / kd;
+
+			if (!(y < x))
+			{
+				return x;
+			}
+
+			x = move(y);
+		}
+	}
+
+	/**
+	 * @brief Most non-squares are rejected by the residues modulo 256 and modulo 2^24 - 1 = 9 * 5 * 7 * 13 * 17 * 241,
+	 * before the square root is calculated.
+	 *
+	 * @param n
+	 * @return bool
+	 */
+	bool is_perfect_square(const dint &n)
+	{
+		static const vector<bool> mod256 = square_residues(256);
+		static const unsigned int moduli[] = {9, 5, 7, 13, 17, 241};
+		static const vector<bool> tables[] = {square_residues(9),  square_residues(5),	square_residues(7),
+											  square_residues(13), square_residues(17), square_residues(241)};
+
+		if (is_zero(n))
+		{
+			return true;
+		}
+
+		if (n.negative || !mod256[n.front()])
+		{
+			return false;
+		}
+
+		unsigned long long r = mod_word(n, (1ULL << 24) - 1);
+
+		for (size_t i = 0; i < size(moduli); i++)
+		{
+			if (!tables[i][r % moduli[i]])
+			{
+				return false;
+			}
+		}
+
+		dint s, rem;
+		sqrtrem(n, s, rem);
+
+		return is_zero(rem);
+	}
+
+	/**
+	 * @brief Whether n = x^k for some integer x and k >= 2.
+	 * The exponent has to divide the multiplicity of every prime factor, which is checked for the small primes first.
+	 * Every remaining prime exponent is checked modulo primes q = 1 (mod p), where only 1 in p residues is a p-th power,
+	 * before the root is calculated.
+	 *
+	 * @param n
+	 * @return bool true for 0, 1 and -1
+	 */
+	bool is_perfect_power(const dint &n)
+	{
+		// Primes below 256
+		static const vector<unsigned long long> small_primes = []
+		{
+			vector<unsigned long long> r;
+			for (unsigned long long q = 2; q < 256; q++)
+			{
+				if (is_prime_word(q))
+				{
+					r.push_back(q);
+				}
+			}
+			return r;
+		}();
+
+		dint m{n};
+		m.negative = false;
+
+		if (m.bit_length() <= 1)
+		{
+			return true;
+		}
+
+		// gcd of the multiplicities of the small prime factors, 0 if there are none
+		unsigned long long g = 0;
+
+		for (unsigned long long f : small_primes)
+		{
+			if (mod_word(m, f) != 0)
+			{
+				continue;
+			}
+
+			const dint d{f};
+			unsigned long long v = 0;
+
+			dint q, r;
+			for (divmod(m, d, q, r); is_zero(r); divmod(m, d, q, r))
+			{
+				m = move(q);
+				v++;
+			}
+
+			g = std::gcd(g, v);
+
+			if (g == 1)
+			{
+				return false;
+			}
+		}
+
+		// Exponents where n < 0 is a power of a negative number
+		auto allowed = [&](unsigned long long p) { return !n.negative || p % 2 == 1; };
+
+		if (m == dint{1ULL})
+		{
+			for (unsigned long long p = 2; p <= g; p++)
+			{
+				if (g % p == 0 && is_prime_word(p) && allowed(p))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// The remaining prime factors are at least 256, so the root has at least 8 bits
+		const size_t max_exponent = m.bit_length() / 8;
+
+		for (unsigned long long p = 2; p <= max_exponent; p++)
+		{
+			if (!is_prime_word(p) || !allowed(p) || (g != 0 && g % p != 0))
+			{
+				continue;
+			}
+
+			// Residue filter with two primes q = 1 (mod p)
+			bool possible = true;
+			int filters	  = 0;
+
+			for (unsigned long long q = 2 * p + 1; filters < 2 && possible; q += 2 * p)
+			{
+				if (!is_prime_word(q))
+				{
+					continue;
+				}
+
+				unsigned long long x = mod_word(m, q);
+				possible			 = x == 0 || powmod_word(x, (q - 1) / p, q) == 1;
+				filters++;
+			}
+
+			if (possible && pow(iroot(m, p), p) == m)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+} // namespace bigint
@@ -0,0 +1,327 @@
+#include "flat_dint_array.h"
+#include "parallel.h"
+
+namespace bigint
+{
+	// Below this many numbers a range is sorted by comparisons
+	constexpr size_t radix_cutoff = 32;
+
+	// With more than one thread, groups of at least this many numbers are split at their top word so the parts run in parallel
+	constexpr size_t split_size = 4096;
+
+	using bounds = array<size_t, 257>;
+
+	/**
+	 * @brief one counting sort pass on word d
+	 *
+	 * @param first
+	 * @param last
+	 * @param tmp scratch space for last - first items
+	 * @param d
+	 * @param b bucket i ends up in [first + b[i], first + b[i + 1])
+	 */
+	template <class item>
+	static void distribute(item *first, item *last, item *tmp, size_t d, bounds &b)
+	{
+		b.fill(0);
+
+		for (item *p = first; p != last; ++p)
+		{
+			b[p->words[d] + 1]++;
+		}
+
+		partial_sum(b.begin(), b.end(), b.begin());
+
+		bounds next = b;
+
+		for (item *p = first; p != last; ++p)
+		{
+			tmp[next[p->words[d]]++] = *p;
+		}
+
+		copy(tmp, tmp + (last - first), first);
+	}
+
+	/**
+	 * @brief MSD radix sort of numbers of the same size on their words d down to 0, ascending
+	 *
+	 * @param first
+	 * @param last
+	 * @param tmp scratch space for last - first items
+	 * @param d
+	 */
+	void flat_dint_array::radix(item *first, item *last, item *tmp, size_t d)
+	{
+		while (true)
+		{
+			const size_t n = last - first;
+
+			if (n < 2)
+			{
+				return;
+			}
+
+			if (n < radix_cutoff)
+			{
+				std::sort(first, last, [d](const item &a, const item &b)
+						  { return dint::compare_words(a.words, b.words, d + 1) < 0; });
+				return;
+			}
+
+			bounds b;
+			distribute(first, last, tmp, d, b);
+
+			if (d == 0)
+			{
+				return;
+			}
+
+			d--;
+
+			// The biggest bucket continues in this loop, the others recurse
+			size_t big = 0;
+			for (size_t i = 1; i < 256; i++)
+			{
+				if (b[i + 1] - b[i] > b[big + 1] - b[big])
+				{
+					big = i;
+				}
+			}
+
+			for (size_t i = 0; i < 256; i++)
+			{
+				if (i != big && b[i + 1] - b[i] > 1)
+				{
+					radix(first + b[i], first + b[i + 1], tmp + b[i], d);
+				}
+			}
+
+			tmp += b[big];
+			last = first + b[big + 1];
+			first += b[big];
+		}
+	}
+
+	/**
+	 * @brief Sorts the items on their value. The items are grouped by sign and size first,
+	 * the negative numbers with the biggest size first. Every group is then radix sorted on its words.
+	 *
+	 * @param items
+	 * @param threads the number of threads to use, 0 for all the hardware has
+	 */
+	void flat_dint_array::sort_items(vector<item> &items, size_t threads)
+	{
+		vector<item> tmp(items.size());
+
+		size_t max_size = 0;
+		for (const item &it : items)
+		{
+			max_size = max(max_size, it.size);
+		}
+
+		// The groups are made with a counting sort on sign and size, unless the sizes are too spread out
+		if (max_size <= 4 * items.size())
+		{
+			auto group = [max_size](const item &it) { return it.negative ? max_size - it.size : max_size + 1 + it.size; };
+
+			vector<size_t> counts(2 * max_size + 3, 0);
+
+			for (const item &it : items)
+			{
+				counts[group(it) + 1]++;
+			}
+
+			partial_sum(counts.begin(), counts.end(), counts.begin());
+
+			for (const item &it : items)
+			{
+				tmp[counts[group(it)]++] = it;
+			}
+
+			items.swap(tmp);
+		}
+		else
+		{
+			std::sort(items.begin(), items.end(),
+					  [](const item &a, const item &b)
+					  {
+						  if (a.negative != b.negative)
+						  {
+							  return a.negative;
+						  }
+						  return a.negative ? a.size > b.size : a.size < b.size;
+					  });
+		}
+
+		struct task
+		{
+			item *first;
+			item *last;
+			size_t d;
+		};
+
+		vector<task> tasks;
+		vector<pair<item *, item *>> negative_groups;
+
+		item *begin = items.data();
+
+		for (size_t i = 0, j; i < items.size(); i = j)
+		{
+			for (j = i + 1; j < items.size() && items[j].negative == items[i].negative && items[j].size == items[i].size; j++)
+			{
+			}
+
+			item *first = begin + i;
+			item *last	= begin + j;
+			size_t d	= items[i].size - 1;
+
+			if (items[i].negative)
+			{
+				negative_groups.emplace_back(first, last);
+			}
+
+			if (threads != 1 && j - i >= split_size && d > 0)
+			{
+				bounds b;
+				distribute(first, last, tmp.data() + i, d, b);
+
+				for (size_t k = 0; k < 256; k++)
+				{
+					tasks.push_back({first + b[k], first + b[k + 1], d - 1});
+				}
+			}
+			else
+			{
+				tasks.push_back({first, last, d});
+			}
+		}
+
+		// The tasks are disjoint ranges, so they can share tmp
+		parallel_for(tasks.size(), threads,
+					 [&](size_t t)
+					 { radix(tasks[t].first, tasks[t].last, tmp.data() + (tasks[t].first - begin), tasks[t].d); });
+
+		// Sorted on the absolute value, so the negative numbers are the wrong way around
+		for (auto [first, last] : negative_groups)
+		{
+			reverse(first, last);
+		}
+	}
+
+	/**
+	 * @brief sorts the numbers ascending
+	 *
+	 * @param a
+	 * @param threads the number of threads to use, 0 for all the hardware has
+	 */
+	void sort_dints(span<dint> a, size_t threads)
+	{
+		vector<flat_dint_array::item> items(a.size());
+
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			const dint &x = a[i];
+			items[i]	  = {x.data.data(), x.size(), x.negative && !(x.size() == 1 && x.data[0] == 0), i};
+		}
+
+		flat_dint_array::sort_items(items, threads);
+
+		vector<dint> sorted;
+		sorted.reserve(a.size());
+
+		for (const auto &it : items)
+		{
+			sorted.push_back(move(a[it.index]));
+		}
+
+		move(sorted.begin(), sorted.end(), a.begin());
+	}
+
+	flat_dint_array::flat_dint_array(span<const dint> a)
+	{
+		offsets.reserve(a.size() + 1);
+		signs.reserve(a.size());
+
+		for (const dint &x : a)
+		{
+			push_back(x);
+		}
+	}
+
+	void flat_dint_array::push_back(const dint &a)
+	{
+		limbs.insert(limbs.end(), a.data.begin(), a.data.end());
+		offsets.push_back(limbs.size());
+		signs.push_back(a.negative && !(a.size() == 1 && a.data[0] == 0));
+	}
+
+	size_t flat_dint_array::size() const
+	{
+		return signs.size();
+	}
+
+	dint flat_dint_array::operator[](size_t i) const
+	{
+		dint r{container(limbs.begin() + offsets[i], limbs.begin() + offsets[i + 1])};
+		r.negative = signs[i];
+		return r;
+	}
+
+	span<const base> flat_dint_array::words(size_t i) const
+	{
+		return {limbs.data() + offsets[i], offsets[i + 1] - offsets[i]};
+	}
+
+	bool flat_dint_array::negative(size_t i) const
+	{
+		return signs[i];
+	}
+
+	vector<dint> flat_dint_array::to_dints() const
+	{
+		vector<dint> r;
+		r.reserve(size());
+
+		for (size_t i = 0; i < size(); i++)
+		{
+			r.push_back((*this)[i]);
+		}
+
+		return r;
+	}
+
+	/**
+	 * @brief sorts the numbers ascending, the words are moved into their new order in a new buffer
+	 *
+	 * @param threads the number of threads to use, 0 for all the hardware has
+	 */
+	void flat_dint_array::sort(size_t threads)
+	{
+		vector<item> items(size());
+
+		for (size_t i = 0; i < size(); i++)
+		{
+			items[i] = {limbs.data() + offsets[i], offsets[i + 1] - offsets[i], signs[i], i};
+		}
+
+		sort_items(items, threads);
+
+		container sorted_limbs(limbs.size());
+		vector<size_t> sorted_offsets{0};
+		vector<bool> sorted_signs;
+
+		sorted_offsets.reserve(offsets.size());
+		sorted_signs.reserve(signs.size());
+
+		for (const item &it : items)
+		{
+			copy(it.words, it.words + it.size, sorted_limbs.begin() + sorted_offsets.back());
+			sorted_offsets.push_back(sorted_offsets.back() + it.size);
+			sorted_signs.push_back(it.negative);
+		}
+
+		limbs	= move(sorted_limbs);
+		offsets = move(sorted_offsets);
+		signs	= move(sorted_signs);
+	}
+} // namespace bigint
@@ -0,0 +1,92 @@
+#include "stats.h"
+
+namespace bigint
+{
+#ifdef BIGINT_STATS
+	thread_local stats counters;
+#endif
+
+	static const char *const names[stats::operations] = {"add", "sub", "mul", "div", "gcd", "shift"};
+
+	stats snapshot()
+	{
+#ifdef BIGINT_STATS
+		return counters;
+#else
+		return stats{};
+#endif
+	}
+
+	void reset()
+	{
+#ifdef BIGINT_STATS
+		counters = stats{};
+#endif
+	}
+
+	/**
+	 * @brief adds the counters of another thread, the peak and depths become the maximum of both
+	 */
+	stats &stats::operator+=(const stats &a)
+	{
+		for (size_t op = 0; op < operations; op++)
+		{
+			calls[op] += a.calls[op];
+
+			for (size_t i = 0; i < buckets; i++)
+			{
+				sizes[op][i] += a.sizes[op][i];
+			}
+		}
+
+		karatsuba += a.karatsuba;
+		karatsuba_depth = max(karatsuba_depth, a.karatsuba_depth);
+		basicmult += a.basicmult;
+		basicmult_limbs += a.basicmult_limbs;
+		additer += a.additer;
+		additer_limbs += a.additer_limbs;
+		subiter += a.subiter;
+		subiter_limbs += a.subiter_limbs;
+		allocations += a.allocations;
+		allocated_bytes += a.allocated_bytes;
+		deallocations += a.deallocations;
+		live_bytes += a.live_bytes;
+		peak_bytes = max(peak_bytes, a.peak_bytes);
+
+		return *this;
+	}
+
+	/**
+	 * @brief writes "name value" lines, the histograms as "op.words.N value" for the buckets that are not empty,
+	 * where N is the upper bound of the bucket
+	 */
+	void stats::write(ostream &out) const
+	{
+		for (size_t op = 0; op < operations; op++)
+		{
+			out << names[op] << ".calls " << calls[op] << '\n';
+
+			for (size_t i = 0; i < buckets; i++)
+			{
+				if (sizes[op][i] != 0)
+				{
+					out << names[op] << ".words." << ((uint64_t{1} << i) - 1) << ' ' << sizes[op][i] << '\n';
+				}
+			}
+		}
+
+		out << "karatsuba.calls " << karatsuba << '\n';
+		out << "karatsuba.depth " << karatsuba_depth << '\n';
+		out << "basicmult.calls " << basicmult << '\n';
+		out << "basicmult.limbs " << basicmult_limbs << '\n';
+		out << "additer.calls " << additer << '\n';
+		out << "additer.limbs " << additer_limbs << '\n';
+		out << "subiter.calls " << subiter << '\n';
+		out << "subiter.limbs " << subiter_limbs << '\n';
+		out << "alloc.calls " << allocations << '\n';
+		out << "alloc.bytes " << allocated_bytes << '\n';
+		out << "free.calls " << deallocations << '\n';
+		out << "live.bytes " << live_bytes << '\n';
+		out << "peak.bytes " << peak_bytes << '\n';
+	}
+} // namespace bigint
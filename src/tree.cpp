@@ -0,0 +1,138 @@
+#include "dint.h"
+#include "parallel.h"
+
+namespace bigint
+{
+	/**
+	 * @brief The products of neighbours, level by level, until one number is left.
+	 * Level 0 holds the numbers themselves, level k + 1 the products of the pairs in level k,
+	 * where the last number of a level with an odd size goes up as it is. The last level holds the product of all.
+	 * Pairing neighbours keeps the operands of every multiplication about the same size, where karatsuba is at its best.
+	 * The nodes of a level are independent and are multiplied in parallel.
+	 *
+	 * @param a
+	 * @param threads the number of threads to use, 0 for all the hardware has
+	 * @return vector<vector<dint>> only level 0, which is empty, when a is empty
+	 */
+	vector<vector<dint>> product_tree(span<const dint> a, size_t threads)
+	{
+		vector<vector<dint>> tree;
+		tree.emplace_back(a.begin(), a.end());
+
+		while (tree.back().size() > 1)
+		{
+			const vector<dint> &below = tree.back();
+			vector<dint> level((below.size() + 1) / 2);
+
+			parallel_for(level.size(), threads,
+						 [&](size_t i)
+						 {
+							 if (2 * i + 1 < below.size())
+							 {
+								 mult(below[2 * i], below[2 * i + 1], level[i]);
+							 }
+							 else
+							 {
+								 level[i] = below[2 * i];
+							 }
+						 });
+
+			tree.push_back(move(level));
+		}
+
+		return tree;
+	}
+
+	/**
+	 * @brief x reduced from the root of the tree down to its leaves, every node by the remainder of its parent.
+	 * A remainder of the parent is smaller than the product of the children, so every division at a level
+	 * has about the size of the node and the whole tree costs about as much as a few products of everything.
+	 *
+	 * @param x
+	 * @param tree from product_tree
+	 * @param squares reduce by the squares of the nodes instead of the nodes
+	 * @param threads
+	 * @return vector<dint> the remainders at level 0
+	 */
+	static vector<dint> descend(const dint &x, const vector<vector<dint>> &tree, bool squares, size_t threads)
+	{
+		auto reduce = [squares](const dint &a, const dint &m) { return squares ? a % (m * m) : a % m; };
+
+		vector<dint> r;
+
+		if (tree.back().empty())
+		{
+			return r;
+		}
+
+		r.push_back(reduce(x, tree.back()[0]));
+
+		for (size_t k = tree.size() - 1; k-- > 0;)
+		{
+			const vector<dint> &level = tree[k];
+			vector<dint> next(level.size());
+
+			parallel_for(next.size(), threads, [&](size_t i) { next[i] = reduce(r[i / 2], level[i]); });
+
+			r = move(next);
+		}
+
+		return r;
+	}
+
+	/**
+	 * @brief x mod m for every m in the moduli, with the product tree of the moduli.
+	 * The tree can be built once and used for many x.
+	 *
+	 * @param x
+	 * @param tree product_tree of the moduli
+	 * @param threads the number of threads to use, 0 for all the hardware has
+	 * @return vector<dint> x mod tree[0][i] at index i
+	 * @pre{all moduli are positive}
+	 */
+	vector<dint> remainder_tree(const dint &x, const vector<vector<dint>> &tree, size_t threads)
+	{
+		return descend(x, tree, false, threads);
+	}
+
+	/**
+	 * @brief x mod m for every m in the moduli.
+	 *
+	 * @param x
+	 * @param moduli
+	 * @param threads the number of threads to use, 0 for all the hardware has
+	 * @return vector<dint> x mod moduli[i] at index i
+	 * @pre{all moduli are positive}
+	 */
+	vector<dint> remainder_tree(const dint &x, span<const dint> moduli, size_t threads)
+	{
+		return descend(x, product_tree(moduli, threads), false, threads);
+	}
+
+	/**
+	 * @brief gcd(a_i, the product of all others) for every a_i, without computing a gcd per pair.
+	 * With P the product of all, P mod a_i^2 is found for every i with the remainder tree of the squares,
+	 * and (P mod a_i^2) / a_i = (P / a_i) mod a_i, of which the gcd with a_i is taken.
+	 * A result other than 1 means a_i shares a factor with another number.
+	 *
+	 * @param a
+	 * @param threads the number of threads to use, 0 for all the hardware has
+	 * @return vector<dint> the gcd for a[i] at index i
+	 * @pre{all numbers are positive}
+	 */
+	vector<dint> batch_gcd(span<const dint> a, size_t threads)
+	{
+		vector<vector<dint>> tree = product_tree(a, threads);
+
+		if (a.empty())
+		{
+			return {};
+		}
+
+		vector<dint> r = descend(tree.back()[0], tree, true, threads);
+
+		parallel_for(r.size(), threads, [&](size_t i) { r[i] = gcd(r[i] / a[i], a[i]); });
+
+		return r;
+	}
+} // namespace bigint
@@ -0,0 +1,134 @@
+#include "tuning.h"
+
+#include <fstream>
+
+namespace bigint
+{
+	// The name of every threshold in the config file and the generated header
+	static const pair<const char *, size_t thresholds::*> fields[] = {
+		{"mul", &thresholds::mul}, {"hgcd", &thresholds::hgcd}, {"rational", &thresholds::rational}};
+
+	/**
+	 * @brief reads "name = value" lines, unknown names, empty lines and lines starting with # are skipped
+	 *
+	 * @param file
+	 * @throw runtime_error if the file can not be read or a value is not a number, the thresholds are then unchanged
+	 */
+	void thresholds::load(const string &file)
+	{
+		ifstream in{file};
+		thresholds r = *this;
+
+		if (!in)
+		{
+			throw runtime_error("cannot read thresholds from " + file);
+		}
+
+		string line;
+
+		while (getline(in, line))
+		{
+			if (line.empty() || line[0] == '#')
+			{
+				continue;
+			}
+
+			auto eq = line.find('=');
+
+			if (eq == string::npos)
+			{
+				continue;
+			}
+
+			istringstream name{line.substr(0, eq)};
+			string key;
+			name >> key;
+
+			for (auto [field, member] : fields)
+			{
+				if (key != field)
+				{
+					continue;
+				}
+
+				const string value = line.substr(eq + 1);
+
+				try
+				{
+					size_t end;
+					r.*member = stoul(value, &end);
+
+					if (value.find_first_not_of(" \t\r", end) != string::npos)
+					{
+						throw invalid_argument(value);
+					}
+				}
+				catch (const logic_error &)
+				{
+					throw runtime_error("threshold " + key + " in " + file + " is not a number: " + value);
+				}
+			}
+		}
+
+		*this = r;
+	}
+
+	void thresholds::save(const string &file) const
+	{
+		ofstream out{file};
+
+		if (!out)
+		{
+			throw runtime_error("cannot write thresholds to " + file);
+		}
+
+		for (auto [field, member] : fields)
+		{
+			out << field << " = " << this->*member << '\n';
+		}
+	}
+
+	/**
+	 * @brief the contents of thresholds.h
+	 */
+	string thresholds::header() const
+	{
+		ostringstream r;
+
+		r << "#pragma once\n\n// Generated by make tune\n\n";
+
+		for (auto [field, member] : fields)
+		{
+			string name{field};
+			transform(name.begin(), name.end(), name.begin(), [](char c) { return static_cast<char>(toupper(c)); });
+
+			r << "#define BIGINT_" << name << "_THRESHOLD " << this->*member << '\n';
+		}
+
+		return r.str();
+	}
+
+	/**
+	 * @brief runs before main for tuning, where an exception would end the program, so errors only go to cerr
+	 */
+	thresholds thresholds::from_environment()
+	{
+		thresholds t;
+
+		if (const char *file = getenv("BIGINT_THRESHOLDS"))
+		{
+			try
+			{
+				t.load(file);
+			}
+			catch (const exception &e)
+			{
+				cerr << "bigint: " << e.what() << ", using the default thresholds" << endl;
+			}
+		}
+
+		return t;
+	}
+
+	thresholds tuning = thresholds::from_environment();
+} // namespace bigint
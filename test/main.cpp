@@ -1,8 +1,25 @@
 #include <dint.h>
+#include <philox.h>
+#include <tuning.h>
+#include <flat_dint_array.h>
+#include <multimodular.h>
+#include <dfloat.h>
+#include <drational.h>
+#include <dpoly.h>
+#include <async.h>
+#include <mapped_dint.h>
+#include <montgomery.h>
 
 #include <random>
 #include <chrono>
 #include <algorithm>
+#include <numeric>
+#include <unordered_set>
+#include <filesystem>
+#include <fstream>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace bigint;
 
@@ -46,7 +63,8 @@ bool testAddition(std::mt19937 gen, size_t n)
 
 bool testSubstraction(std::mt19937 gen, size_t n)
 {
-	std::uniform_int_distribution<long long> distrib(numeric_limits<long long>::min(), numeric_limits<long long>::max());
+	// Half the range, so a - b does not overflow
+	std::uniform_int_distribution<long long> distrib(numeric_limits<long long>::min() / 2, numeric_limits<long long>::max() / 2);
 
 	long long a, b, s;
 
@@ -188,6 +206,1815 @@ bool testMultiplicationSimple(std::mt19937 gen, size_t n, int size)
 	return true;
 }
 
+dint fromSigned(long long x)
+{
+	dint r{static_cast<unsigned long long>(x < 0 ? -x : x)};
+	return x < 0 ? -r : r;
+}
+
+bool sameValue(const dint &a, const dint &b)
+{
+	return a == b && a.neg() == b.neg();
+}
+
+bool testBitwise(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<long long> distrib(-(1LL << 62), 1LL << 62);
+	std::uniform_int_distribution<int> distribbit(0, 70);
+
+	long long a, b;
+
+	dint da, db;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		a = distrib(gen);
+		b = distrib(gen);
+
+		da = fromSigned(a);
+		db = fromSigned(b);
+
+		int bit = distribbit(gen);
+
+		dint ds{da}, dc{da};
+		ds.set_bit(bit);
+		dc.clear_bit(bit);
+
+		long long mask = bit < 63 ? (1LL << bit) : 0;
+		bool expectedbit = bit < 63 ? ((a >> bit) & 1) : a < 0;
+
+		if (!sameValue(da & db, fromSigned(a & b)) || !sameValue(da | db, fromSigned(a | b)) ||
+			!sameValue(da ^ db, fromSigned(a ^ b)) || !sameValue(~da, fromSigned(~a)) ||
+			da.test_bit(bit) != expectedbit || (bit < 62 && !sameValue(ds, fromSigned(a | mask))) ||
+			(bit < 62 && !sameValue(dc, fromSigned(a & ~mask))))
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << hex << a << endl;
+			cout << "b: " << hex << b << endl;
+			cout << "bit: " << dec << bit << endl;
+
+			cout << "a & b:\t" << (da & db).toHexString() << endl;
+			cout << "a | b:\t" << (da | db).toHexString() << endl;
+			cout << "a ^ b:\t" << (da ^ db).toHexString() << endl;
+			cout << "~a:\t" << (~da).toHexString() << endl;
+
+			throw runtime_error("");
+		}
+
+		unsigned long long ua = a < 0 ? -a : a;
+		unsigned long long ub = b < 0 ? -b : b;
+
+		if (da.popcount() != static_cast<size_t>(std::popcount(ua)) ||
+			da.bit_length() != static_cast<size_t>(std::bit_width(ua)) ||
+			(ua != 0 && da.countr_zero() != static_cast<size_t>(std::countr_zero(ua))) ||
+			hamming_distance(da, db) != static_cast<size_t>(std::popcount(ua ^ ub)))
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << hex << a << endl;
+			cout << "b: " << hex << b << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	return true;
+}
+
+bool testDivision(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<long long> distriba(-(1LL << 62), 1LL << 62);
+	std::uniform_int_distribution<int> distribshift(0, 62);
+
+	long long a, b;
+
+	dint q, r;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		a = distriba(gen);
+		b = distriba(gen) >> distribshift(gen);
+
+		if (b == 0)
+		{
+			b = 1;
+		}
+
+		divmod(fromSigned(a), fromSigned(b), q, r);
+
+		if (!sameValue(q, fromSigned(a / b)) || !sameValue(r, fromSigned(a % b)))
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << hex << a << endl;
+			cout << "b: " << hex << b << endl;
+
+			cout << "q:\t" << q.toHexString() << endl;
+			cout << "r:\t" << r.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	return true;
+}
+
+bool testGcd(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<long long> distrib(-(1LL << 31), 1LL << 31);
+	std::uniform_int_distribution<base> distribword(0, numeric_limits<base>::max());
+	std::uniform_int_distribution<int> distribsize(1, 300);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		long long a = distrib(gen);
+		long long b = distrib(gen);
+
+		dint s, t;
+		dint g = gcdext(fromSigned(a), fromSigned(b), s, t);
+
+		auto value = [](const dint &x)
+		{
+			__int128 v = static_cast<unsigned long long>(x);
+			return x.neg() ? -v : v;
+		};
+
+		if (g != dint{std::gcd(static_cast<unsigned long long>(a < 0 ? -a : a), static_cast<unsigned long long>(b < 0 ? -b : b))} ||
+			value(s) * a + value(t) * b != value(g))
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << hex << a << endl;
+			cout << "b: " << hex << b << endl;
+
+			cout << "g:\t" << g.toHexString() << endl;
+			cout << "s:\t" << s.toHexString() << endl;
+			cout << "t:\t" << t.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	for (size_t i = 0; i < n / 10; i++)
+	{
+		dint a, b, c;
+
+		a.random(distribsize(gen), distribword, gen);
+		b.random(distribsize(gen), distribword, gen);
+		c.random(distribsize(gen) / 10 + 1, distribword, gen);
+
+		a = (a | dint{1ULL}) * c;
+		b = (b | dint{1ULL}) * c;
+
+		dint g = gcd(a, b);
+
+		if (!(a % g == Nil) || !(b % g == Nil) || !(g % c == Nil) || !(gcd(a / g, b / g) == dint{1ULL}))
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << a.toHexString() << endl;
+			cout << "b: " << b.toHexString() << endl;
+
+			cout << "g:\t" << g.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+
+		dint m = b | dint{1ULL};
+		if (gcd(a, m) == dint{1ULL} && !((a * invmod(a, m)) % m == dint{1ULL}))
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << a.toHexString() << endl;
+			cout << "m: " << m.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	return true;
+}
+
+bool testRoots(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<unsigned long long> distrib(0, numeric_limits<unsigned long long>::max());
+	std::uniform_int_distribution<base> distribword(0, numeric_limits<base>::max());
+	std::uniform_int_distribution<int> distribsize(1, 200);
+	std::uniform_int_distribution<unsigned long long> distribk(2, 7);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		unsigned long long a = distrib(gen) >> (i % 64);
+		unsigned long long k = distribk(gen);
+
+		unsigned long long r = static_cast<unsigned long long>(iroot(dint{a}, k));
+
+		auto power = [k](unsigned long long x)
+		{
+			unsigned __int128 p = 1;
+			for (unsigned long long j = 0; j < k; j++)
+			{
+				p *= x;
+			}
+			return p;
+		};
+
+		if (power(r) > a || power(r + 1) <= a)
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << hex << a << endl;
+			cout << "k: " << dec << k << endl;
+			cout << "r: " << hex << r << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	for (size_t i = 0; i < n / 10; i++)
+	{
+		dint a;
+		a.random(distribsize(gen), distribword, gen);
+		a |= dint{1ULL} << 8;
+
+		dint s, r;
+		sqrtrem(a, s, r);
+
+		dint s1{s};
+		++s1;
+
+		dint c = iroot(a, 3);
+		dint c1{c};
+		++c1;
+
+		if (!(s * s + r == a) || !(s * s <= a) || !(s1 * s1 > a) || !(pow(c, 3) <= a) || !(pow(c1, 3) > a) ||
+			!is_perfect_square(s * s) || is_perfect_square(s * s + dint{1ULL}) || !is_perfect_power(pow(s, 5)) ||
+			!is_perfect_power(-pow(c, 3)))
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << a.toHexString() << endl;
+			cout << "s: " << s.toHexString() << endl;
+			cout << "r: " << r.toHexString() << endl;
+			cout << "c: " << c.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	return true;
+}
+
+bool testPrimes(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<unsigned long long> distrib(2, 1ULL << 20);
+	std::uniform_int_distribution<base> distribword(0, numeric_limits<base>::max());
+	std::uniform_int_distribution<int> distribsize(1, 40);
+
+	auto naive = [](unsigned long long x)
+	{
+		for (unsigned long long d = 2; d * d <= x; d++)
+		{
+			if (x % d == 0)
+			{
+				return false;
+			}
+		}
+		return x >= 2;
+	};
+
+	for (size_t i = 0; i < n; i++)
+	{
+		unsigned long long x = distrib(gen);
+
+		if (is_probable_prime(dint{x}) != naive(x))
+		{
+			cout << "error" << endl;
+
+			cout << "x: " << dec << x << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	// Mersenne primes, Carmichael numbers and the product of two Mersenne primes
+	const dint one{1ULL};
+	container ones89(12, numeric_limits<base>::max());
+	ones89.back() = 1;
+	container ones127(16, numeric_limits<base>::max());
+	ones127.back() = 0x7f;
+
+	const dint m89{ones89};
+	const dint m127{ones127};
+
+	if (!is_probable_prime(m89) || !is_probable_prime(m127, 5) || is_probable_prime(m89 * m127) ||
+		is_probable_prime(dint{561ULL}) || is_probable_prime(dint{3825123056546413051ULL}) ||
+		is_probable_prime((one << 89) + one) || next_prime(m89 ^ one) != m89)
+	{
+		cout << "error" << endl;
+
+		throw runtime_error("");
+	}
+
+	for (size_t i = 0; i < n / 10; i++)
+	{
+		dint p = random_prime(64 + i % 200, gen);
+
+		dint a;
+		a.random(distribsize(gen), distribword, gen);
+
+		dint e;
+		e.random(distribsize(gen) / 4 + 1, distribword, gen);
+
+		dint m;
+		m.random(distribsize(gen), distribword, gen);
+		m |= dint{2ULL};
+
+		dint r{1ULL};
+		for (size_t j = e.bit_length(); j-- > 0;)
+		{
+			r = (r * r) % m;
+			if (e.test_bit(j))
+			{
+				r = (r * a) % m;
+			}
+		}
+
+		if (p.bit_length() != 64 + i % 200 || !is_probable_prime(p) || powmod(a | one, p ^ one, p) != one ||
+			powmod(a, e, m) != r || powmod(a, e, m | one) != powmod(a % (m | one), e, m | one))
+		{
+			cout << "error" << endl;
+
+			cout << "p: " << p.toHexString() << endl;
+			cout << "a: " << a.toHexString() << endl;
+			cout << "e: " << e.toHexString() << endl;
+			cout << "m: " << m.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	// One Montgomery context shared by several threads
+	dint m;
+	m.random(48, distribword, gen);
+	m |= one;
+
+	const montgomery context{m};
+
+	vector<dint> xs(4), ys(4);
+	vector<char> ok(4, 0);
+
+	for (size_t k = 0; k < xs.size(); k++)
+	{
+		xs[k].random_below(m, gen);
+		ys[k].random_below(m, gen);
+	}
+
+	{
+		vector<thread> threads;
+
+		for (size_t k = 0; k < xs.size(); k++)
+		{
+			threads.emplace_back(
+				[&, k]
+				{
+					ok[k] = 1;
+
+					for (size_t j = 0; j < 50; j++)
+					{
+						montgomery::words p;
+						context.mul(context.to(xs[k]), context.to(ys[k]), p);
+
+						ok[k] = ok[k] && context.from(p) == xs[k] * ys[k] % m;
+					}
+				});
+		}
+
+		for (thread &t : threads)
+		{
+			t.join();
+		}
+	}
+
+	if (count(ok.begin(), ok.end(), 1) != static_cast<ptrdiff_t>(ok.size()))
+	{
+		cout << "error" << endl;
+		cout << "shared montgomery context, m: " << m.toHexString() << endl;
+
+		throw runtime_error("");
+	}
+
+	return true;
+}
+
+bool testRandom(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribbits(1, 500);
+
+	// Known answer of Philox4x32-10
+	array<uint32_t, 4> r = philox::block({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0});
+
+	if (r != array<uint32_t, 4>{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1})
+	{
+		cout << "error" << endl;
+
+		cout << "philox: " << hex << r[0] << ' ' << r[1] << ' ' << r[2] << ' ' << r[3] << endl;
+
+		throw runtime_error("");
+	}
+
+	philox p{gen()};
+
+	for (size_t i = 0; i < n; i++)
+	{
+		size_t bits = distribbits(gen);
+
+		dint x, y, z;
+		x.random_bits(bits, gen);
+		y.random_exact_bits(bits, p);
+		z.random_below(y, gen);
+
+		if (x.bit_length() > bits || y.bit_length() != bits || !(z < y) || z.neg())
+		{
+			cout << "error" << endl;
+
+			cout << "bits: " << dec << bits << endl;
+			cout << "x: " << x.toHexString() << endl;
+			cout << "y: " << y.toHexString() << endl;
+			cout << "z: " << z.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	// Skipping ahead gives the same outputs as drawing them
+	for (unsigned long long skip = 0; skip < 10; skip++)
+	{
+		philox a{skip, 1}, b{skip, 1};
+
+		for (unsigned long long i = 0; i < skip; i++)
+		{
+			a();
+		}
+		b.discard(skip);
+
+		if (a() != b() || a() != b() || a() != b())
+		{
+			cout << "error" << endl;
+
+			cout << "skip: " << dec << skip << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	// The batch fills every dint from the generator in order
+	vector<dint> batch(10);
+	philox c{1}, d{1};
+
+	dint::random_bits(span<dint>{batch}, 100, c);
+
+	for (dint &x : batch)
+	{
+		dint y;
+		y.random_bits(100, d);
+
+		if (x != y)
+		{
+			cout << "error" << endl;
+
+			cout << "x: " << x.toHexString() << endl;
+			cout << "y: " << y.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	return true;
+}
+
+bool testTuning(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribbits(8, 2000);
+	std::uniform_int_distribution<size_t> distribthreshold(1, 40);
+
+	const thresholds saved = tuning;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		dint a, b;
+		a.random_bits(distribbits(gen), gen);
+		b.random_bits(distribbits(gen), gen);
+
+		tuning.mul = numeric_limits<size_t>::max();
+		dint p = a * b;
+
+		tuning.mul = distribthreshold(gen);
+		dint q = a * b;
+
+		if (p != q)
+		{
+			cout << "error" << endl;
+
+			cout << "threshold: " << dec << tuning.mul << endl;
+			cout << "a: " << a.toHexString() << endl;
+			cout << "b: " << b.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	// The config file round trips
+	thresholds t;
+	t.mul  = 17;
+	t.hgcd = 1234;
+
+	const string file = "bin/thresholds.test.conf";
+	t.save(file);
+
+	thresholds u;
+	u.load(file);
+	remove(file.c_str());
+
+	tuning = saved;
+
+	if (u.mul != 17 || u.hgcd != 1234 || t.header().find("#define BIGINT_MUL_THRESHOLD 17") == string::npos)
+	{
+		cout << "error" << endl;
+
+		cout << "mul: " << dec << u.mul << endl;
+		cout << "hgcd: " << u.hgcd << endl;
+
+		throw runtime_error("");
+	}
+
+	// A file that can not be read, or has a value that is not a number, leaves the thresholds as they were
+	{
+		ofstream bad{file};
+		bad << "hgcd = 99\nmul = abc\n";
+	}
+
+	for (const string &path : {string{"/nonexistent/thresholds.conf"}, file})
+	{
+		thresholds v;
+		bool thrown = false;
+
+		try
+		{
+			v.load(path);
+		}
+		catch (const runtime_error &)
+		{
+			thrown = true;
+		}
+
+		setenv("BIGINT_THRESHOLDS", path.c_str(), 1);
+		const thresholds w = thresholds::from_environment();
+		unsetenv("BIGINT_THRESHOLDS");
+
+		if (!thrown || v.mul != BIGINT_MUL_THRESHOLD || v.hgcd != BIGINT_HGCD_THRESHOLD || w.mul != BIGINT_MUL_THRESHOLD ||
+			w.hgcd != BIGINT_HGCD_THRESHOLD)
+		{
+			cout << "error" << endl;
+
+			cout << "file: " << path << endl;
+			cout << "mul: " << dec << v.mul << ' ' << w.mul << endl;
+			cout << "hgcd: " << v.hgcd << ' ' << w.hgcd << endl;
+
+			remove(file.c_str());
+			throw runtime_error("");
+		}
+	}
+
+	remove(file.c_str());
+
+	return true;
+}
+
+bool testStats(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribwords(tuning.mul + 1, 200);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		dint a, b;
+		a.random_exact_bits(distribwords(gen) * bits_per_word, gen);
+		b.random_exact_bits(distribwords(gen) * bits_per_word, gen);
+
+		reset();
+		dint p = a * b;
+		stats s = snapshot();
+
+		size_t words  = max(a.size(), b.size());
+		size_t bucket = static_cast<size_t>(bit_width(words));
+
+		ostringstream out;
+		s.write(out);
+
+#ifdef BIGINT_STATS
+		bool ok = s.calls[stats::mul] == 1 && s.sizes[stats::mul][bucket] == 1 && s.karatsuba > 0 && s.basicmult > 0 &&
+				  s.karatsuba_depth > 0 && s.depth == 0 && s.additer_limbs > 0 && s.allocations > 0 &&
+				  out.str().find("mul.calls 1\n") != string::npos;
+#else
+		bool ok = s.calls[stats::mul] == 0 && s.sizes[stats::mul][bucket] == 0 && s.karatsuba == 0 && s.allocations == 0 &&
+				  out.str().find("mul.calls 0\n") != string::npos;
+#endif
+
+		if (!ok)
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << a.toHexString() << endl;
+			cout << "b: " << b.toHexString() << endl;
+			cout << out.str();
+
+			throw runtime_error("");
+		}
+	}
+
+	return true;
+}
+
+bool testAllocator(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribbits(8, 3000);
+
+	arena a;
+	limb_pool pool;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		dint x, y;
+		x.random_bits(distribbits(gen), gen);
+		y.random_bits(distribbits(gen), gen);
+
+		dint expected = x * y + (x - y) * x;
+
+		// Results assigned to numbers from outside the scope stay valid after the arena is released
+		dint in_arena, in_pool;
+
+		{
+			resource_scope scope{&a};
+			dint p = x * y + (x - y) * x;
+			in_arena = move(p);
+		}
+
+		size_t used = a.used();
+		a.release();
+
+		{
+			resource_scope scope{&pool};
+			in_pool = x * y + (x - y) * x;
+		}
+
+		if (in_arena != expected || in_pool != expected || used == 0 || current_resource != nullptr)
+		{
+			cout << "error" << endl;
+
+			cout << "x: " << x.toHexString() << endl;
+			cout << "y: " << y.toHexString() << endl;
+			cout << "arena: " << in_arena.toHexString() << endl;
+			cout << "pool: " << in_pool.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	return true;
+}
+
+bool testCompare(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribbits(1, 600);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		dint a, b;
+		a.random_bits(distribbits(gen), gen);
+
+		// Equal except for a few low bits, so the search has to go down to them
+		b = gen() % 2 ? a + dint{static_cast<unsigned long long>(gen() % 4)} : dint{};
+		if (b == dint{})
+		{
+			b.random_bits(distribbits(gen), gen);
+		}
+
+		if (gen() % 2)
+		{
+			a = -a;
+		}
+		if (gen() % 2)
+		{
+			b = -b;
+		}
+
+		dint d = a - b;
+
+		int expected = d.neg() ? -1 : d == dint{} ? 0 : 1;
+		int c		 = compare(a, b);
+
+		bool ok = (c > 0) - (c < 0) == expected && ((a <=> b) == 0) == (expected == 0) && ((a <=> b) < 0) == (expected < 0) &&
+				  (a == b) == (expected == 0) && (a < b) == (expected < 0) && (a > b) == (expected > 0) &&
+				  (a <= b) == (expected <= 0) && (a >= b) == (expected >= 0);
+
+		if (!ok)
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << a.toHexString() << endl;
+			cout << "b: " << b.toHexString() << endl;
+			cout << "compare: " << dec << c << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	if (dint{-5LL} == dint{5ULL} || !(dint{-5LL} < dint{5ULL}) || -dint{} != dint{})
+	{
+		cout << "error" << endl;
+		cout << "signs are not compared" << endl;
+
+		throw runtime_error("");
+	}
+
+	return true;
+}
+
+bool testHash(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribbits(1, 600);
+
+	unordered_set<dint> seen;
+	vector<dint> values;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		dint a, b;
+		a.random_bits(distribbits(gen), gen);
+		b.random_bits(distribbits(gen), gen);
+
+		if (gen() % 2)
+		{
+			a = -a;
+		}
+
+		// The same value built in another way
+		dint c = (a + b) - b;
+
+		if (a.hash() != c.hash() || hash<dint>{}(a) != a.hash())
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << a.toHexString() << endl;
+			cout << "c: " << c.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+
+		// Small values repeat, so the set has to find them again
+		dint d{static_cast<unsigned long long>(gen() % 64)};
+
+		seen.insert(a);
+		seen.insert(d);
+		values.push_back(a);
+		values.push_back(d);
+	}
+
+	sort(values.begin(), values.end());
+	size_t distinct = unique(values.begin(), values.end()) - values.begin();
+
+	if (seen.size() != distinct || (-dint{}).hash() != dint{}.hash() || dint{container(4, base{0})}.hash() != dint{}.hash())
+	{
+		cout << "error" << endl;
+
+		cout << "distinct: " << dec << distinct << endl;
+		cout << "in the set: " << seen.size() << endl;
+
+		throw runtime_error("");
+	}
+
+	return true;
+}
+
+bool testSort(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribbits(1, 120);
+
+	// Enough numbers with the same size and top words that the radix passes and the parallel split are used
+	vector<dint> values(n * 50);
+
+	dint prefix;
+	prefix.random_exact_bits(96, gen);
+
+	for (dint &x : values)
+	{
+		if (gen() % 4 == 0)
+		{
+			x.random_bits(distribbits(gen), gen);
+		}
+		else
+		{
+			x.random_bits(16, gen);
+			x = x + prefix;
+		}
+
+		if (gen() % 4 == 0)
+		{
+			x = -x;
+		}
+	}
+
+	vector<dint> expected{values};
+	sort(expected.begin(), expected.end());
+
+	vector<dint> serial{values}, parallel{values};
+	sort_dints(serial);
+	sort_dints(parallel, 4);
+
+	flat_dint_array flat{values};
+	flat.sort(2);
+	vector<dint> packed = flat.to_dints();
+
+	if (serial != expected || parallel != expected || packed != expected)
+	{
+		cout << "error" << endl;
+
+		for (size_t i = 0; i < expected.size(); i++)
+		{
+			if (serial[i] != expected[i] || parallel[i] != expected[i] || packed[i] != expected[i])
+			{
+				cout << "at " << dec << i << endl;
+				cout << "expected: " << expected[i].toHexString() << endl;
+				cout << "serial: " << serial[i].toHexString() << endl;
+				cout << "parallel: " << parallel[i].toHexString() << endl;
+				cout << "packed: " << packed[i].toHexString() << endl;
+				break;
+			}
+		}
+
+		throw runtime_error("");
+	}
+
+	return true;
+}
+
+bool testTrees(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribbits(1, 300);
+
+	vector<dint> moduli(n / 4 + 3);
+
+	dint shared;
+	shared.random_exact_bits(64, gen);
+
+	for (dint &m : moduli)
+	{
+		m.random_exact_bits(distribbits(gen), gen);
+
+		// Some of the numbers have a factor in common
+		if (gen() % 3 == 0)
+		{
+			m = m * shared;
+		}
+	}
+
+	dint product{1ULL};
+	for (const dint &m : moduli)
+	{
+		product = product * m;
+	}
+
+	dint x;
+	x.random_bits(distribbits(gen) * 20, gen);
+
+	vector<vector<dint>> tree = product_tree(moduli, 4);
+	vector<dint> remainders = remainder_tree(x, tree, 4);
+	vector<dint> serial = remainder_tree(x, span<const dint>{moduli});
+	vector<dint> gcds = batch_gcd(moduli, 3);
+
+	for (size_t i = 0; i < moduli.size(); i++)
+	{
+		const dint &m = moduli[i];
+
+		if (tree.back()[0] != product || remainders[i] != x % m || serial[i] != x % m || gcds[i] != gcd(m, product / m))
+		{
+			cout << "error" << endl;
+			cout << "at " << dec << i << endl;
+
+			cout << "m: " << m.toHexString() << endl;
+			cout << "x: " << x.toHexString() << endl;
+
+			cout << "remainder: " << remainders[i].toHexString() << endl;
+			cout << "serial: " << serial[i].toHexString() << endl;
+			cout << "gcd: " << gcds[i].toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	return true;
+}
+
+bool testMultimodular(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribbits(1, 400);
+
+	const size_t chain = 8;
+
+	multimodular mm(chain * 400);
+
+	for (size_t i = 0; i < n / 10; i++)
+	{
+		dint product{1ULL}, sum;
+
+		multimodular::residues rproduct = mm.to(product), rsum = mm.to(sum);
+
+		for (size_t j = 0; j < chain; j++)
+		{
+			dint x;
+			x.random_bits(distribbits(gen), gen);
+
+			if (gen() % 2 == 0)
+			{
+				x = -x;
+			}
+
+			multimodular::residues rx = mm.to(x, 2);
+
+			product = product * x;
+			mm.mul(rproduct, rx, rproduct);
+
+			if (j % 2 == 0)
+			{
+				sum = sum + x;
+				mm.add(rsum, rx, rsum);
+			}
+			else
+			{
+				sum = sum - x;
+				mm.sub(rsum, rx, rsum);
+			}
+		}
+
+		dint p = mm.from(rproduct, 2);
+		dint s = mm.from(rsum);
+
+		if (p != product || s != sum)
+		{
+			cout << "error" << endl;
+
+			cout << "product:\t" << product.toHexString() << endl;
+			cout << "residues:\t" << p.toHexString() << endl;
+			cout << "sum:\t" << sum.toHexString() << endl;
+			cout << "residues:\t" << s.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	return true;
+}
+
+bool testExact(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribbits(1, 600);
+
+	for (size_t i = 0; i < n * 10; i++)
+	{
+		dint q, d;
+		q.random_bits(distribbits(gen), gen);
+
+		// Half of the divisors fit in a machine word
+		d.random_bits(i % 2 == 0 ? distribbits(gen) % 64 + 1 : distribbits(gen), gen);
+
+		if (d == dint{})
+		{
+			continue;
+		}
+
+		d <<= static_cast<unsigned int>(gen() % 12);
+
+		if (gen() % 2 == 0)
+		{
+			q = -q;
+		}
+		if (gen() % 2 == 0)
+		{
+			d = -d;
+		}
+
+		dint a = q * d;
+
+		// Every third one is off by a little
+		if (i % 3 == 0)
+		{
+			a = a + dint{static_cast<unsigned long long>(gen() % 5 + 1)};
+		}
+
+		dint dq, dr;
+		divmod(a, d, dq, dr);
+
+		const bool divides = dr == dint{};
+
+		bool error = divisible_p(a, d) != divides || (divides && divexact(a, d) != dq) || !congruent_p(a + q * d, a, d);
+
+		if (d.size() <= 8)
+		{
+			const unsigned long long w = static_cast<unsigned long long>(d);
+			const dint expected		   = d.neg() ? -dq : dq;
+
+			error = error || divisible_p(a, w) != divides || (divides && divexact_by_small(a, w) != expected);
+		}
+
+		if (error)
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << a.toHexString() << endl;
+			cout << "d: " << d.toHexString() << endl;
+			cout << "divides: " << divides << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	// a = q d - 2^192 with d = 2^128 - s: the second quotient word borrows out of the top and leaves zeros above
+	for (size_t i = 0; i < n / 10; i++)
+	{
+		const dint one{1ULL};
+
+		const dint d  = (one << 128) - dint{static_cast<unsigned long long>(gen() % 1000 * 2 + 1)};
+		const dint q0 = (one << 63) + dint{static_cast<unsigned long long>(gen() | 1ULL << 31)};
+		const dint a  = ((one << 64) + q0) * d - (one << 192);
+
+		if (a % d == dint{} || divisible_p(a, d) || congruent_p(a, dint{}, d))
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << a.toHexString() << endl;
+			cout << "d: " << d.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	return true;
+}
+
+bool testShortProducts(std::mt19937 gen, size_t n)
+{
+	for (size_t i = 0; i < n * 5; i++)
+	{
+		// Past the schoolbook cutoff so the Mulders splits are used as well
+		const unsigned long long words = gen() % 150 + 1;
+
+		dint a, b, c;
+		a.random_bits(gen() % (8 * words) + 1, gen);
+		b.random_bits(gen() % (8 * words) + 1, gen);
+		c.random_bits(gen() % (16 * words) + 1, gen);
+
+		if (gen() % 2 == 0)
+		{
+			a = -a;
+		}
+
+		dint radix{1ULL};
+		radix <<= static_cast<unsigned int>(8 * words);
+
+		dint p = a * b;
+		dint pc = c * b;
+
+		dint low = p % radix;
+		dint high = p / radix;
+		dint middle = (pc / radix) % radix;
+
+		dint ml = mullow(a, b, words);
+		dint mh = mulhigh(a, b, words);
+		dint mm = middle_product(c, b, words);
+
+		// The high and middle words may be up to words - 1 too small
+		dint dh = high.neg() ? mh - high : high - mh;
+		dint dm = (middle - mm + radix) % radix;
+
+		if (ml != low || dh.neg() || dh >= dint{words} || dm >= dint{words})
+		{
+			cout << "error" << endl;
+			cout << "words: " << dec << words << endl;
+
+			cout << "a: " << a.toHexString() << endl;
+			cout << "b: " << b.toHexString() << endl;
+			cout << "c: " << c.toHexString() << endl;
+
+			cout << "mullow: " << ml.toHexString() << endl;
+			cout << "low: " << low.toHexString() << endl;
+			cout << "mulhigh: " << mh.toHexString() << endl;
+			cout << "high: " << high.toHexString() << endl;
+			cout << "middle_product: " << mm.toHexString() << endl;
+			cout << "middle: " << middle.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	return true;
+}
+
+// Whether r is the number of its precision nearest to n 2^k / d, ties to even
+bool nearest(const dfloat &r, const dint &n, long long k, const dint &d)
+{
+	if (r.is_zero() || r.mantissa().bit_length() != r.precision())
+	{
+		return r.is_zero() && n == dint{};
+	}
+
+	// |n 2^k / d - m 2^e| <= 2^e / 2, all at the exponent min(k, e - 1)
+	const long long e = r.exponent();
+	const long long low = min(k, e - 1);
+
+	dint diff = (n << static_cast<unsigned int>(k - low)) - ((r.mantissa() * d) << static_cast<unsigned int>(e - low));
+
+	if (diff.neg())
+	{
+		diff = -diff;
+	}
+
+	const int c = compare(diff << 1, d << static_cast<unsigned int>(e - low));
+
+	return c < 0 || (c == 0 && !r.mantissa().test_bit(0));
+}
+
+bool testFloat(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribprec(1, 300);
+	std::uniform_int_distribution<long long> distribexp(-300, 300);
+
+	auto random_float = [&](size_t prec)
+	{
+		dint m;
+		m.random_exact_bits(prec, gen);
+
+		if (gen() % 2 == 0)
+		{
+			m = -m;
+		}
+
+		return dfloat{m, prec};
+	};
+
+	for (size_t i = 0; i < n * 5; i++)
+	{
+		// Now and then long operands with a short result, so they are cut
+		const size_t pa = i % 4 == 0 ? 2000 : distribprec(gen);
+		const size_t pb = i % 8 == 0 ? 2000 : distribprec(gen);
+		const size_t prec = distribprec(gen);
+
+		const long long ea = distribexp(gen);
+		const long long eb = gen() % 3 == 0 ? ea + distribexp(gen) % 8 : distribexp(gen);
+
+		dfloat a = ldexp(random_float(pa), ea);
+		dfloat b = ldexp(random_float(pb), eb);
+
+		if (i % 10 == 0)
+		{
+			b = a;
+		}
+
+		const dint ma = a.mantissa(), mb = b.mantissa();
+		const long long xa = a.exponent(), xb = b.exponent();
+
+		const long long emin = min(xa, xb);
+
+		const dint sa = ma << static_cast<unsigned int>(xa - emin);
+		const dint sb = mb << static_cast<unsigned int>(xb - emin);
+
+		dfloat s = add(a, b, prec);
+		dfloat d = sub(a, b, prec);
+		dfloat p = mul(a, b, prec);
+		dfloat q = div(a, b, prec);
+
+		const dint one{1ULL};
+
+		bool ok = nearest(s, sa + sb, emin, one) && nearest(d, sa - sb, emin, one) && nearest(p, ma * mb, xa + xb, one);
+
+		// a / b = ma / mb 2^(xa - xb), with the sign in the numerator
+		ok = ok && nearest(q, mb.neg() ? -ma : ma, xa - xb, mb.neg() ? -mb : mb);
+
+		ok = ok && (compare(a, b) <=> 0) == (compare(sa, sb) <=> 0);
+
+		if (!a.neg())
+		{
+			// (2m - 1)^2 2^(2e - 2) <= a <= (2m + 1)^2 2^(2e - 2)
+			dfloat r = sqrt(a, prec);
+
+			const dint m2 = r.mantissa() << 1;
+			const long long e2 = 2 * r.exponent() - 2;
+			const long long low = min(e2, xa);
+
+			const dint x = ma << static_cast<unsigned int>(xa - low);
+			const dint below = ((m2 - one) * (m2 - one)) << static_cast<unsigned int>(e2 - low);
+			const dint above = ((m2 + one) * (m2 + one)) << static_cast<unsigned int>(e2 - low);
+
+			ok = ok && r.mantissa().bit_length() == prec && below <= x && x <= above;
+		}
+
+		if (!ok)
+		{
+			cout << "error" << endl;
+			cout << "precision: " << dec << prec << endl;
+
+			cout << "a: " << a.toHexString() << endl;
+			cout << "b: " << b.toHexString() << endl;
+
+			cout << "a + b: " << s.toHexString() << endl;
+			cout << "a - b: " << d.toHexString() << endl;
+			cout << "a * b: " << p.toHexString() << endl;
+			cout << "a / b: " << q.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	return true;
+}
+
+bool testRational(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribbits(1, 200);
+	std::uniform_int_distribution<size_t> distribthreshold(1, 100);
+
+	const thresholds saved = tuning;
+
+	auto random_fraction = [&]()
+	{
+		dint a, b;
+		a.random_bits(distribbits(gen), gen);
+
+		do
+		{
+			b.random_bits(distribbits(gen), gen);
+		} while (b.bit_length() == 0);
+
+		if (gen() % 2 == 0)
+		{
+			a = -a;
+		}
+
+		return pair{a, b};
+	};
+
+	// Reduced by hand after every step
+	auto reduce = [](dint &a, dint &b)
+	{
+		const dint g = gcd(a, b);
+		a /= g;
+		b /= g;
+	};
+
+	for (size_t i = 0; i < n; i++)
+	{
+		// Small thresholds take the Henrici paths, a large one only cross multiplies
+		tuning.rational = i % 2 == 0 ? distribthreshold(gen) : numeric_limits<size_t>::max();
+
+		auto [a, b] = random_fraction();
+
+		drational x{a, b};
+		reduce(a, b);
+
+		for (size_t j = 0; j < 8; j++)
+		{
+			auto [c, d] = random_fraction();
+			const drational y{c, d};
+
+			switch (gen() % 4)
+			{
+			case 0:
+				x += y;
+				a = a * d + c * b;
+				b = b * d;
+				break;
+			case 1:
+				x -= y;
+				a = a * d - c * b;
+				b = b * d;
+				break;
+			case 2:
+				x *= y;
+				a = a * c;
+				b = b * d;
+				break;
+			default:
+				if (c.bit_length() == 0)
+				{
+					continue;
+				}
+
+				x /= y;
+				a = a * d;
+				b = b * c;
+
+				if (b.neg())
+				{
+					a = -a;
+					b = -b;
+				}
+				break;
+			}
+
+			reduce(a, b);
+		}
+
+		const drational z = x + drational{dint{1ULL}};
+
+		// Reading a fraction does not reduce it in place, canonicalize does
+		const bool lazy = x.is_canonical();
+		bool ok			= x.numerator() == a && x.denominator() == b && x.is_canonical() == lazy;
+
+		x.canonicalize();
+		ok = ok && x.is_canonical();
+		ok		= ok && x == drational{a, b} && x < z && compare(z, x) > 0 && z - x == drational{dint{1ULL}};
+
+		if (!ok)
+		{
+			cout << "error" << endl;
+			cout << "threshold: " << dec << tuning.rational << endl;
+
+			cout << "x: " << x.toHexString() << endl;
+			cout << "expected: " << a.toHexString() << "/" << b.toHexString() << endl;
+
+			tuning = saved;
+			throw runtime_error("");
+		}
+	}
+
+	tuning = saved;
+
+	// 1/3 is rounded the same way as the division of dfloats
+	const drational third{dint{1ULL}, dint{3ULL}};
+	const dfloat q = div(dfloat{dint{1ULL}}, dfloat{dint{3ULL}}, 53);
+
+	if (third.to_dfloat(53) != q || static_cast<double>(third.to_dfloat(53)) != 1.0 / 3.0)
+	{
+		cout << "error" << endl;
+		cout << "1/3: " << third.to_dfloat(53).toHexString() << endl;
+		throw runtime_error("");
+	}
+
+	return true;
+}
+
+bool testPolynomials(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribsize(0, 24);
+	std::uniform_int_distribution<size_t> distribbits(1, 64);
+
+	auto random_poly = [&](size_t size, size_t bits, bool monic)
+	{
+		vector<dint> c(size);
+
+		for (dint &x : c)
+		{
+			x.random_bits(bits, gen);
+
+			if (gen() % 2 == 0)
+			{
+				x = -x;
+			}
+		}
+
+		if (monic && size > 0)
+		{
+			c.back() = gen() % 2 == 0 ? dint{1ULL} : dint{-1LL};
+		}
+
+		return dpoly{c};
+	};
+
+	for (size_t i = 0; i < n / 20; i++)
+	{
+		const size_t bits = distribbits(gen);
+
+		const dpoly a = random_poly(distribsize(gen), bits, false);
+		const dpoly b = random_poly(distribsize(gen), bits, false);
+		const dpoly d = random_poly(distribsize(gen) + 1, bits, true);
+
+		// Coefficient by coefficient
+		vector<dint> naive(a.is_zero() || b.is_zero() ? 0 : a.coefficients().size() + b.coefficients().size() - 1);
+
+		for (size_t j = 0; j < a.coefficients().size(); j++)
+		{
+			for (size_t k = 0; k < b.coefficients().size(); k++)
+			{
+				naive[j + k] += a[j] * b[k];
+			}
+		}
+
+		const dpoly p = a * b;
+
+		dpoly q, r;
+		divrem(p, d, q, r);
+
+		dint m;
+		m.random_bits(distribbits(gen), gen);
+		m += dint{2ULL};
+
+		dpoly qm, rm;
+		divrem(p, d, qm, rm, m);
+
+		// Large enough for the Newton division, the quotient and remainder are unique
+		const dpoly qe = mod(random_poly(distribsize(gen) + 40, bits, false), m);
+		const dpoly de = mod(random_poly(40, bits, true), m);
+		const dpoly re = mod(random_poly(distribsize(gen) % 40, bits, false), m);
+
+		dpoly qn, rn;
+		divrem(mulmod(qe, de, m) + re, de, qn, rn, m);
+
+		vector<dint> points(distribsize(gen));
+
+		for (dint &x : points)
+		{
+			x.random_bits(distribbits(gen), gen);
+		}
+
+		const vector<dint> values	= p.evaluate(points);
+		const vector<dint> valuesm = p.evaluate(points, m);
+
+		bool ok = p == dpoly{naive} && q * d + r == p && r.degree() < d.degree();
+		ok		= ok && mulmod(a, b, m) == mod(p, m) && mod(mulmod(qm, d, m) + rm, m) == mod(p, m) && rm.degree() < d.degree();
+		ok		= ok && qn == qe && rn == re;
+
+		for (size_t j = 0; j < points.size() && ok; j++)
+		{
+			dint v = values[j] % m;
+
+			if (v.neg())
+			{
+				v += m;
+			}
+
+			ok = values[j] == p.evaluate(points[j]) && valuesm[j] == v && valuesm[j] == p.evaluate(points[j], m);
+		}
+
+		if (!ok)
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << a.toHexString() << endl;
+			cout << "b: " << b.toHexString() << endl;
+			cout << "d: " << d.toHexString() << endl;
+			cout << "m: " << m.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	return true;
+}
+
+// Runs as soon as it is called and is never awaited itself
+struct detached
+{
+	struct promise_type
+	{
+		detached get_return_object()
+		{
+			return {};
+		}
+
+		std::suspend_never initial_suspend()
+		{
+			return {};
+		}
+
+		std::suspend_never final_suspend() noexcept
+		{
+			return {};
+		}
+
+		void return_void() {}
+
+		void unhandled_exception()
+		{
+			std::terminate();
+		}
+	};
+};
+
+detached await_product(dint a, dint b, std::promise<dint> result)
+{
+	result.set_value(co_await async_mult(a, b));
+}
+
+bool testAsync(std::mt19937 gen, size_t n)
+{
+	std::uniform_int_distribution<size_t> distribbits(1, 4000);
+
+	// The decimal digits read back
+	for (size_t i = 0; i < n / 4; i++)
+	{
+		dint a;
+		a.random_bits(distribbits(gen), gen);
+
+		if (gen() % 2 == 0)
+		{
+			a = -a;
+		}
+
+		const string s = to_string(a);
+		const size_t sign = s[0] == '-' ? 1 : 0;
+
+		dint b;
+
+		for (size_t j = sign; j < s.size(); j++)
+		{
+			b *= dint{10ULL};
+			b += dint{static_cast<unsigned long long>(s[j] - '0')};
+		}
+
+		if (sign == 1)
+		{
+			b = -b;
+		}
+
+		if (b != a || (s.size() > sign + 1 && s[sign] == '0'))
+		{
+			cout << "error" << endl;
+			cout << "a: " << a.toHexString() << endl;
+			cout << "to_string(a): " << s << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	thread_pool pool{2};
+
+	dint a, b, e, m;
+	a.random_exact_bits(24000, gen);
+	b.random_exact_bits(16000, gen);
+	e.random_exact_bits(256, gen);
+	m.random_exact_bits(512, gen);
+
+	vector<double> reported;
+
+	async_options options;
+	options.on		 = &pool;
+	options.progress = [&](double f) { reported.push_back(f); };
+
+	const dint p = async_mult(a, b, options).get_future().get();
+
+	bool ok = p == a * b && reported.size() > 2 && reported.back() == 1.0 && is_sorted(reported.begin(), reported.end());
+
+	const pair<dint, dint> qr = async_divmod(a, b).get_future().get();
+	ok = ok && qr.first == a / b && qr.second == a % b;
+
+	m.set_bit(0);
+	ok = ok && async_powmod(a, e, m).get_future().get() == powmod(a, e, m);
+
+	m.clear_bit(0);
+	ok = ok && async_powmod(a, e, m).get_future().get() == powmod(a, e, m);
+
+	ok = ok && async_to_string(-b).get_future().get() == to_string(-b);
+
+	std::promise<dint> awaited;
+	std::future<dint> product = awaited.get_future();
+	await_product(a, b, move(awaited));
+
+	ok = ok && product.get() == p;
+
+	// Cancelled before it starts and halfway
+	auto cancelled = [&](async_options o)
+	{
+		try
+		{
+			async_mult(a, b, move(o)).get_future().get();
+		}
+		catch (const operation_cancelled &)
+		{
+			return true;
+		}
+
+		return false;
+	};
+
+	async_options before;
+	before.token.cancel();
+
+	async_options halfway;
+	halfway.progress = [token = halfway.token](double f)
+	{
+		if (f > 0.5)
+		{
+			token.cancel();
+		}
+	};
+
+	ok = ok && cancelled(before) && cancelled(halfway);
+
+	if (!ok)
+	{
+		cout << "error" << endl;
+		cout << "a: " << a.toHexString() << endl;
+		cout << "b: " << b.toHexString() << endl;
+
+		throw runtime_error("");
+	}
+
+	return true;
+}
+
+// A file in the temp directory with a name no other run uses, removed when it goes out of scope
+struct temp_file
+{
+	string path{std::filesystem::temp_directory_path().string() + "/bigintXXXXXX"};
+
+	temp_file()
+	{
+		const int fd = mkstemp(path.data());
+
+		if (fd < 0)
+		{
+			throw runtime_error("cannot create " + path);
+		}
+
+		close(fd);
+	}
+
+	~temp_file()
+	{
+		std::error_code e;
+		std::filesystem::remove(path, e);
+	}
+
+	temp_file(const temp_file &)			= delete;
+	temp_file &operator=(const temp_file &) = delete;
+};
+
+bool testMapped(std::mt19937 gen, size_t n)
+{
+	// main does not catch, so without this handler a failure would end the program before the files are removed
+	try
+	{
+		const temp_file fa, fb, fd;
+
+		for (size_t i = 0; i < n / 10; i++)
+		{
+			// Tiles of 64 words with a budget of 0, so products of a few hundred words go through every path
+			dint a, b;
+			a.random_bits(gen() % 5000, gen);
+			b.random_bits(gen() % 2 == 0 ? gen() % 5000 : gen() % 600, gen);
+
+			mapped_dint ma{fa.path, a};
+			mapped_dint mb{fb.path, b};
+			mapped_dint md{fd.path, Nil};
+
+			mult(ma, mb, md, gen() % 2 == 0 ? 0 : 2048);
+
+			dint d = md.to_dint();
+
+			if (d != a * b || md.size() != ma.size() + mb.size())
+			{
+				cout << "error" << endl;
+
+				cout << "a: " << a.toHexString() << endl;
+				cout << "b: " << b.toHexString() << endl;
+				cout << "mapped: " << d.toHexString() << endl;
+				cout << "product: " << (a * b).toHexString() << endl;
+
+				throw runtime_error("");
+			}
+		}
+	}
+	catch (...)
+	{
+		throw;
+	}
+
+	return true;
+}
+
+bool testStreams(std::mt19937 gen, size_t n)
+{
+	for (size_t i = 0; i < n / 10; i++)
+	{
+		dint a;
+		a.random_bits(gen() % 3000, gen);
+
+		if (gen() % 2 == 0)
+		{
+			a = -a;
+		}
+
+		stringstream decimal, hex;
+		write_decimal(a, ostream_sink(decimal));
+		write_hex(a, ostream_sink(hex));
+
+		// Line breaks between the digits are skipped
+		string digits = decimal.str();
+
+		for (size_t j = gen() % 80 + 1; j < digits.size(); j += gen() % 80 + 2)
+		{
+			digits.insert(j, "\n");
+		}
+
+		istringstream din{" " + digits + "\n"}, hin{hex.str()}, tin{a.toHexString()};
+
+		dint d = read_decimal(istream_source(din));
+		dint h = read_hex(istream_source(hin));
+		dint t = read_hex(istream_source(tin));
+
+		if (decimal.str() != to_string(a) || d != a || h != a || t != a)
+		{
+			cout << "error" << endl;
+
+			cout << "a: " << a.toHexString() << endl;
+			cout << "decimal: " << decimal.str() << endl;
+			cout << "hex: " << hex.str() << endl;
+			cout << "read decimal: " << d.toHexString() << endl;
+			cout << "read hex: " << h.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	// Several blocks of decimal digits, checked modulo primes against the digits themselves
+	{
+		string digits(1, static_cast<char>('1' + gen() % 9));
+
+		for (size_t i = 0; i < 40000; i++)
+		{
+			digits += static_cast<char>('0' + gen() % 10);
+		}
+
+		istringstream in{digits};
+		dint d = read_decimal(istream_source(in));
+
+		for (unsigned long long p : {1000000007ULL, 998244353ULL})
+		{
+			unsigned long long r = 0;
+
+			for (char c : digits)
+			{
+				r = (r * 10 + static_cast<unsigned long long>(c - '0')) % p;
+			}
+
+			if (static_cast<unsigned long long>(d % dint{p}) != r)
+			{
+				cout << "error" << endl;
+				cout << "decimal of " << digits.size() << " digits modulo " << p << endl;
+
+				throw runtime_error("");
+			}
+		}
+	}
+
+	// Through a file descriptor
+	{
+		dint a, d;
+		a.random_bits(4000, gen);
+
+		{
+			const temp_file file;
+			const int fd = open(file.path.c_str(), O_RDWR);
+
+			write_decimal(a, fd_sink(fd));
+			lseek(fd, 0, SEEK_SET);
+
+			d = read_decimal(fd_source(fd));
+
+			close(fd);
+		}
+
+		if (d != a)
+		{
+			cout << "error" << endl;
+			cout << "a: " << a.toHexString() << endl;
+			cout << "read: " << d.toHexString() << endl;
+
+			throw runtime_error("");
+		}
+	}
+
+	for (const char *bad : {"", "  ", "-", "12x4", "0x1f"})
+	{
+		istringstream in{bad};
+
+		try
+		{
+			read_decimal(istream_source(in));
+
+			cout << "error" << endl;
+			cout << "read \"" << bad << "\"" << endl;
+
+			throw runtime_error("");
+		}
+		catch (const domain_error &)
+		{
+		}
+	}
+
+	return true;
+}
+
 int main(int argc, char const *argv[])
 {
 	std::random_device rd;	// Will be used to obtain a seed for the random number engine
@@ -204,6 +2031,28 @@ int main(int argc, char const *argv[])
 	cout << testSubstraction(gen, n);
 	cout << testMultiplication(gen, n);
 	cout << testMultiplicationWithBase(gen, n);
+	cout << testBitwise(gen, n);
+	cout << testDivision(gen, n);
+	cout << testGcd(gen, n);
+	cout << testRoots(gen, n);
+	cout << testPrimes(gen, n);
+	cout << testRandom(gen, n);
+	cout << testTuning(gen, n);
+	cout << testStats(gen, n);
+	cout << testAllocator(gen, n);
+	cout << testCompare(gen, n);
+	cout << testHash(gen, n);
+	cout << testSort(gen, n);
+	cout << testTrees(gen, n);
+	cout << testMultimodular(gen, n);
+	cout << testExact(gen, n);
+	cout << testShortProducts(gen, n);
+	cout << testFloat(gen, n);
+	cout << testRational(gen, n);
+	cout << testPolynomials(gen, n);
+	cout << testAsync(gen, n);
+	cout << testMapped(gen, n);
+	cout << testStreams(gen, n);
 
 	return 0;
 }
@@ -0,0 +1,239 @@
+#include <dint.h>
+#include <philox.h>
+#include <tuning.h>
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+
+using namespace bigint;
+
+struct options
+{
+	size_t max_mul{160};
+	size_t max_hgcd{6000};
+	double min_time{0.01};
+	int repeats{5};
+	string header{};
+	string config{};
+};
+
+// Keeps the results of the measured operations alive
+static volatile size_t sink;
+
+/**
+ * @brief seconds per call of f, the minimum over a number of repeats of batches that each take at least min_time
+ */
+static double measure(const function<void()> &f, const options &opt)
+{
+	size_t calls = 1;
+
+	while (true)
+	{
+		auto t0 = chrono::steady_clock::now();
+		for (size_t i = 0; i < calls; i++)
+		{
+			f();
+		}
+		double t = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+		if (t >= opt.min_time)
+		{
+			break;
+		}
+
+		calls = t <= 0 ? calls * 10 : max(calls + 1, static_cast<size_t>(calls * opt.min_time / t * 1.2));
+	}
+
+	double best = numeric_limits<double>::max();
+
+	for (int r = 0; r < opt.repeats; r++)
+	{
+		auto t0 = chrono::steady_clock::now();
+		for (size_t i = 0; i < calls; i++)
+		{
+			f();
+		}
+		best = min(best, chrono::duration<double>(chrono::steady_clock::now() - t0).count() / static_cast<double>(calls));
+	}
+
+	return best;
+}
+
+/**
+ * @brief The first size where the faster method stays faster for the next sizes as well.
+ *
+ * @param sizes increasing
+ * @param faster whether the new method is faster at a size
+ * @param confirm the number of sizes in a row that have to agree
+ * @return the index of the crossover, sizes.size() if there is none
+ */
+static size_t crossover(const vector<size_t> &sizes, const function<bool(size_t)> &faster, size_t confirm)
+{
+	size_t run = 0;
+
+	for (size_t i = 0; i < sizes.size(); i++)
+	{
+		run = faster(sizes[i]) ? run + 1 : 0;
+
+		if (run == confirm)
+		{
+			return i + 1 - confirm;
+		}
+	}
+
+	return sizes.size();
+}
+
+/**
+ * @brief Schoolbook against one level of Karatsuba, whose halves use the schoolbook method.
+ * Only even sizes are measured: at an odd size karatsuba peels off a word and does the rest by the schoolbook method
+ * when the threshold is one below it, so it would lose without being split at all.
+ * Karatsuba is used above the threshold, so the threshold is one below the crossover.
+ */
+static size_t tune_mul(const options &opt, philox &gen)
+{
+	vector<size_t> sizes;
+	for (size_t n = 4; n <= opt.max_mul; n += 2)
+	{
+		sizes.push_back(n);
+	}
+
+	auto faster = [&](size_t n)
+	{
+		dint a, b, r;
+		a.random_exact_bits(n * bits_per_word, gen);
+		b.random_exact_bits(n * bits_per_word, gen);
+
+		tuning.mul = n;
+		double schoolbook = measure([&] { mult(a, b, r); sink = r.size(); }, opt);
+
+		tuning.mul = n - 1;
+		double karatsuba = measure([&] { mult(a, b, r); sink = r.size(); }, opt);
+
+		cout << "mul " << n << " words: schoolbook " << schoolbook * 1e9 << " ns, karatsuba " << karatsuba * 1e9 << " ns"
+			 << endl;
+
+		return karatsuba < schoolbook;
+	};
+
+	size_t i = crossover(sizes, faster, 3);
+
+	return i < sizes.size() ? sizes[i] - 1 : opt.max_mul;
+}
+
+/**
+ * @brief Lehmer steps against the half gcd at the top level
+ */
+static size_t tune_hgcd(const options &opt, philox &gen)
+{
+	vector<size_t> sizes;
+	for (size_t n = 100; n <= opt.max_hgcd; n = n * 3 / 2)
+	{
+		sizes.push_back(n);
+	}
+
+	auto faster = [&](size_t n)
+	{
+		dint a, b;
+		a.random_exact_bits(n * bits_per_word, gen);
+		b.random_exact_bits(n * bits_per_word, gen);
+
+		tuning.hgcd = numeric_limits<size_t>::max();
+		double lehmer = measure([&] { sink = gcd(a, b).size(); }, opt);
+
+		tuning.hgcd = n;
+		double half = measure([&] { sink = gcd(a, b).size(); }, opt);
+
+		cout << "gcd " << n << " words: lehmer " << lehmer * 1e3 << " ms, half gcd " << half * 1e3 << " ms" << endl;
+
+		return half < lehmer;
+	};
+
+	size_t i = crossover(sizes, faster, 2);
+
+	return i < sizes.size() ? sizes[i] : opt.max_hgcd;
+}
+
+static void usage()
+{
+	cerr << "usage: tune [--header FILE] [--config FILE] [--max-mul WORDS] [--max-hgcd WORDS] [--min-time SECONDS]\n"
+			"            [--repeats N]\n";
+}
+
+int main(int argc, char const *argv[])
+{
+	options opt;
+
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+
+		auto value = [&]() -> string
+		{
+			if (i + 1 >= argc)
+			{
+				usage();
+				exit(2);
+			}
+			return argv[++i];
+		};
+
+		if (arg == "--header")
+		{
+			opt.header = value();
+		}
+		else if (arg == "--config")
+		{
+			opt.config = value();
+		}
+		else if (arg == "--max-mul")
+		{
+			opt.max_mul = stoul(value());
+		}
+		else if (arg == "--max-hgcd")
+		{
+			opt.max_hgcd = stoul(value());
+		}
+		else if (arg == "--min-time")
+		{
+			opt.min_time = stod(value());
+		}
+		else if (arg == "--repeats")
+		{
+			opt.repeats = stoi(value());
+		}
+		else
+		{
+			usage();
+			return 2;
+		}
+	}
+
+	philox gen{2024};
+
+	thresholds result;
+
+	// The gcd depends on the multiplication, so that one goes first
+	result.mul	= tune_mul(opt, gen);
+	tuning.mul	= result.mul;
+	result.hgcd = tune_hgcd(opt, gen);
+
+	tuning = result;
+
+	cout << "mul = " << result.mul << endl;
+	cout << "hgcd = " << result.hgcd << endl;
+
+	if (!opt.header.empty())
+	{
+		ofstream out{opt.header};
+		out << result.header();
+	}
+
+	if (!opt.config.empty())
+	{
+		result.save(opt.config);
+	}
+
+	return 0;
+}